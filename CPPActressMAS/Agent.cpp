@@ -18,25 +18,38 @@
 
 #include "Agent.h"
 
-#include <uuid/UUID.hpp>
+#include <utility>
 
 #include "Environment.h"
 
+namespace {
+	/**
+	 * Agent run by this thread, the agents it creates draw their random stream from its stream
+	 */
+	thread_local cam::Agent* t_running_agent = nullptr;
+}
+
 cam::Agent::Agent(std::string p_name, const bool p_using_observables) :
-		m_id(UUID::generate_uuid()),
+		m_id(AgentId::generate()),
 		m_name(std::move(p_name)),
 		m_environment(nullptr),
 		m_is_setup(false),
 		m_is_dead(false),
+		m_schedule_state(ScheduleState::Idle),
+		m_observables_version(0),
 		m_is_using_observables(p_using_observables),
-		m_observables(new Observables()) {}
+		m_observables(std::make_shared<Observables>()),
+		m_perception_radius(0) {}
 
 cam::Agent::Agent() :
 		m_environment(nullptr),
 		m_is_setup(false),
 		m_is_dead(false),
+		m_schedule_state(ScheduleState::Idle),
+		m_observables_version(0),
 		m_is_using_observables(false),
-		m_observables(new Observables()) {
+		m_observables(std::make_shared<Observables>()),
+		m_perception_radius(0) {
 }
 
 void cam::Agent::run_turn(const bool p_run_setup_separately) {
@@ -44,6 +57,13 @@ void cam::Agent::run_turn(const bool p_run_setup_separately) {
 		return;
 	}
 
+	// The previous running agent is restored on return, even if the agent throws
+	struct RunningAgent {
+		Agent* m_previous;
+
+		~RunningAgent() { t_running_agent = m_previous; }
+	} l_running_agent{std::exchange(t_running_agent, this)};
+
 	if (p_run_setup_separately) {
 		if (!is_setup()) {
 			internal_setup();
@@ -72,20 +92,34 @@ void cam::Agent::run_turn(const bool p_run_setup_separately) {
 	}
 }
 
+cam::Agent* cam::Agent::get_running_agent() {
+	return t_running_agent;
+}
+
 void cam::Agent::internal_setup() {
 	setup();
 	m_is_setup = true;
 }
 
 void cam::Agent::internal_see() {
-	see(m_environment->get_list_of_observable_agents(this));
+	if (!m_delta_perception) {
+		see(m_environment->get_list_of_observable_agents(this));
+		return;
+	}
+	m_environment->update_delta_perception(this, *m_delta_perception);
+	if (!m_delta_perception->empty()) {
+		see_delta(m_delta_perception->get_added(), m_delta_perception->get_changed(),
+				  m_delta_perception->get_removed());
+	}
 }
 
 void cam::Agent::internal_action() {
-	if (MessagePointer l_message; m_messages.dequeue(l_message)) {
+	const auto& l_to_inbox = [this](MessagePointer&& p_message) { m_inbox.push_back(std::move(p_message)); };
+	if (m_messages.drain(l_to_inbox)) {
 		do {
-			action(l_message);
-		} while (m_messages.dequeue(l_message));
+			action_batch(m_inbox);
+			m_inbox.clear();
+		} while (m_messages.drain(l_to_inbox));
 	} else {
 		default_action();
 	}
@@ -93,22 +127,53 @@ void cam::Agent::internal_action() {
 
 void cam::Agent::stop() {
 	m_is_dead = true;
+	if (m_environment) {
+		m_environment->m_agent_collection.set_stopped(m_handle);
+	}
+}
+
+void cam::Agent::post(MessagePointer p_message) {
+	m_messages.enqueue(std::move(p_message));
+	if (m_environment && m_environment->m_agent_collection.is_reactive()) {
+		schedule();
+	}
+}
+
+void cam::Agent::wake_up() {
+	if (m_environment && m_environment->m_agent_collection.is_reactive()) {
+		schedule();
+	}
 }
 
-void cam::Agent::post(const MessagePointer& p_message) {
-	m_messages.enqueue(p_message);
+void cam::Agent::schedule() {
+	// Always a read-modify-write: it pairs with the exchange done before running the agent,
+	// so the message is seen by the run or the agent is scheduled again
+	ScheduleState l_state = m_schedule_state.load(std::memory_order_relaxed);
+	ScheduleState l_next_state;
+	do {
+		l_next_state = l_state == ScheduleState::Idle || l_state == ScheduleState::Scheduled
+					   ? ScheduleState::Scheduled : ScheduleState::Rescheduled;
+	} while (!m_schedule_state.compare_exchange_weak(l_state, l_next_state, std::memory_order_acq_rel,
+													 std::memory_order_relaxed));
+	if (l_state == ScheduleState::Idle) {
+		m_environment->m_agent_collection.schedule(m_handle);
+	}
 }
 
-void cam::Agent::send(const std::string& p_receiver_id, const json& p_message) const {
+void cam::Agent::send(const AgentId& p_receiver_id, const json& p_message) const {
 	const auto& l_binary_data = json::to_msgpack(p_message);
 	get_environment()->send(m_id, p_receiver_id, &l_binary_data[0], l_binary_data.size(),
 							MessageBinaryFormat::MessagePack);
 }
 
-void cam::Agent::send(const std::string& p_receiver_id, const uint8_t* p_message, const size_t& p_length) const {
+void cam::Agent::send(const AgentId& p_receiver_id, const uint8_t* p_message, const size_t& p_length) const {
 	get_environment()->send(m_id, p_receiver_id, p_message, p_length);
 }
 
+void cam::Agent::send_object(const AgentId& p_receiver_id, ObjectPointer p_object) const {
+	get_environment()->send(m_id, p_receiver_id, std::move(p_object));
+}
+
 void
 cam::Agent::send_by_name(const std::string& p_receiver_name, const json& p_message, const bool p_first_only) const {
 	const auto& l_binary_data = json::to_msgpack(p_message);
@@ -158,22 +223,71 @@ size_t cam::Agent::agents_count() const {
 	return get_environment()->agents_count();
 }
 
-std::vector<std::string> cam::Agent::get_agents_by_name(const std::string& p_name, bool p_first_only) const {
+std::vector<cam::AgentId> cam::Agent::get_agents_by_name(const std::string& p_name, bool p_first_only) const {
 	return get_environment()->get_agents_by_name(p_name, p_first_only);
 }
 
-std::optional<std::string> cam::Agent::get_first_agent_by_name(const std::string& p_name) const {
+std::optional<cam::AgentId> cam::Agent::get_first_agent_by_name(const std::string& p_name) const {
 	return get_environment()->get_first_agent_by_name(p_name);
 }
 
-std::optional<std::string> cam::Agent::get_agent_name(const std::string& p_id) const {
+std::optional<std::string> cam::Agent::get_agent_name(const AgentId& p_id) const {
 	return get_environment()->get_agent_name(p_id);
 }
 
-std::vector<std::string> cam::Agent::get_filtered_agents(const std::string& p_fragment_name, bool p_first_only) const {
+std::vector<cam::AgentId> cam::Agent::get_filtered_agents(const std::string& p_fragment_name, bool p_first_only) const {
 	return get_environment()->get_filtered_agents(p_fragment_name, p_first_only);
 }
 
+std::optional<cam::AgentId> cam::Agent::get_agent_id(const AgentHandle& p_handle) const {
+	return get_environment()->get_agent_id(p_handle);
+}
+
+double cam::Agent::get_observable(const ObservableKey p_key) const {
+	return get_environment()->get_observable_columns().get(p_key, m_handle.m_slot);
+}
+
+double cam::Agent::get_observable(const AgentHandle& p_handle, const ObservableKey p_key) const {
+	return get_environment()->get_observable(p_handle, p_key);
+}
+
+std::vector<cam::AgentHandle> cam::Agent::get_agents_in_range(const ObservableKey p_key, const double p_min,
+															   const double p_max) const {
+	return get_environment()->get_agents_in_range(p_key, p_min, p_max, m_handle);
+}
+
+cam::Observables& cam::Agent::edit_observables() {
+	// Still perceived by other agents (or kept by them)
+	if (m_observables.use_count() > 1) {
+		m_observables = std::make_shared<Observables>(*m_observables);
+	}
+	m_observables_version++;
+	if (m_environment) {
+		m_environment->m_agent_collection.set_snapshot_outdated();
+	}
+	// Always created non-const
+	return const_cast<Observables&>(*m_observables);
+}
+
+void cam::Agent::set_delta_perception(const bool p_enabled) {
+	if (!p_enabled) {
+		m_delta_perception.reset();
+	} else if (!m_delta_perception) {
+		m_delta_perception = std::make_unique<DeltaPerception>();
+	} else {
+		m_delta_perception->invalidate();
+	}
+}
+
+std::vector<cam::AgentHandle> cam::Agent::select_agents(const ColumnQuery& p_query) const {
+	return get_environment()->select_agents(p_query, m_handle);
+}
+
+void cam::Agent::set_observable(const ObservableKey p_key, const double p_value) {
+	get_environment()->get_observable_columns().set(p_key, m_handle.m_slot, p_value);
+	m_environment->m_agent_collection.set_snapshot_outdated();
+}
+
 bool cam::Agent::perception_filter(const ObservablesPointer&) const {
 	return false;
 }
@@ -182,6 +296,15 @@ void cam::Agent::setup() {}
 
 void cam::Agent::see(const std::vector<ObservablesPointer>&) {}
 
+void cam::Agent::see_delta(std::span<const PerceivedAgent>, std::span<const PerceivedAgent>,
+						   std::span<const PerceivedAgent>) {}
+
 void cam::Agent::action(const MessagePointer&) {}
 
+void cam::Agent::action_batch(const std::span<const MessagePointer> p_messages) {
+	for (const MessagePointer& l_message: p_messages) {
+		action(l_message);
+	}
+}
+
 void cam::Agent::default_action() {}
@@ -18,13 +18,23 @@
 
 #pragma once
 
+#include <atomic>
+#include <span>
+
 #include <cereal/archives/portable_binary.hpp>
 #include <cereal/types/vector.hpp>            // Serialize vector
 #include <cereal/types/string.hpp>            // Serialize string
 #include <cereal/types/unordered_map.hpp>    // Serialize unordered map
 
+#include "AgentHandle.h"
+#include "AgentId.h"
+#include "ColumnQuery.h"
+#include "DeltaPerception.h"
 #include "MPSCQueue.hpp"
 #include "Message.h"
+#include "ObservableColumns.h"
+#include "PerceptionQuery.h"
+#include "RandomStream.hpp"
 
 /**
  * CPPActressMAS
@@ -32,31 +42,42 @@
 namespace cam {
 	class Environment;
 
+	class AgentCollection;
+
 	class Agent;
 
 	template<typename T>
 	concept ConceptAgent = std::is_base_of_v<Agent, T>;
 
-	/**
-	 * Represents the observable properties of an agent. They depend on the set of
-	 * Observables properties of an agent and on the PerceptionFilter function of an
-	 * agent who wants to observe other agents.
-	 **/
-	using Observables = std::unordered_map<std::string, json>;
-	using ObservablesPointer = std::shared_ptr<const Observables>;
-
 	/**
 	 * The base class for an agent that runs on a turn-based manner in its
 	 * environment. You must create your own agent classes derived from this abstract class.
 	 **/
 	class Agent {
 		friend Environment;
+		friend AgentCollection;
 
 	private:
+		/**
+		 * Scheduling state (Reactive and Asynchronous modes): an agent is scheduled at most once,
+		 * and a message arriving while it runs schedules it again when the run ends.
+		 **/
+		enum class ScheduleState : std::uint8_t {
+			Idle,
+			Scheduled,
+			Running,
+			Rescheduled
+		};
+
 		/**
 		 * Unique ID.
 		 **/
-		std::string m_id;
+		AgentId m_id;
+
+		/**
+		 * Handle in the agent collection.
+		 **/
+		AgentHandle m_handle;
 
 		/**
 		 * Name of the agent.
@@ -78,11 +99,36 @@ namespace cam {
 		 **/
 		bool m_is_dead;
 
+		/**
+		 * Scheduling state (Reactive and Asynchronous modes).
+		 **/
+		std::atomic<ScheduleState> m_schedule_state;
+
 		/**
 		 * Messages arrived.
 		 **/
 		MPSCQueue<MessagePointer> m_messages;
 
+		/**
+		 * Messages drained from m_messages, handed to action_batch (reused across turns).
+		 **/
+		std::vector<MessagePointer> m_inbox;
+
+		/**
+		 * Incremented each time the observables are edited.
+		 **/
+		std::uint64_t m_observables_version;
+
+		/**
+		 * Previous perception, only allocated in delta perception mode.
+		 **/
+		std::unique_ptr<DeltaPerception> m_delta_perception;
+
+		/**
+		 * Random stream of the agent, given by the environment when the agent is added.
+		 **/
+		RandomStream m_random;
+
 	protected:
 
 		/**
@@ -91,9 +137,19 @@ namespace cam {
 		bool m_is_using_observables;
 
 		/**
-		 * List of observables.
+		 * List of observables, read-only: use edit_observables to change them.
+		 **/
+		ObservablesPointer m_observables;
+
+		/**
+		 * Perception radius, used when the environment has spatial perception (0 to see every agent).
+		 **/
+		double m_perception_radius;
+
+		/**
+		 * Perception query, used instead of perception_filter when not empty.
 		 **/
-		std::shared_ptr<Observables> m_observables;
+		PerceptionQuery m_perception_query;
 
 	public:
 		/**
@@ -112,7 +168,13 @@ namespace cam {
 		 * Return id.
 		 * @return Id of the agent
 		 **/
-		[[nodiscard]] const std::string& get_id() const { return m_id; }
+		[[nodiscard]] const AgentId& get_id() const { return m_id; }
+
+		/**
+		 * Return handle.
+		 * @return Handle of the agent in its collection, invalid until the agent is added
+		 **/
+		[[nodiscard]] const AgentHandle& get_handle() const { return m_handle; }
 
 		/**
 		 * Return name.
@@ -132,6 +194,24 @@ namespace cam {
 		 **/
 		[[nodiscard]] ObservablesPointer get_observables() const { return m_observables; }
 
+		/**
+		 * Get perception radius.
+		 * @return Perception radius, 0 if not limited
+		 **/
+		[[nodiscard]] double get_perception_radius() const { return m_perception_radius; }
+
+		/**
+		 * Get perception query.
+		 * @return Perception query, empty if perception_filter is used
+		 **/
+		[[nodiscard]] const PerceptionQuery& get_perception_query() const { return m_perception_query; }
+
+		/**
+		 * True if using delta perception.
+		 * @return True if see_delta is called instead of see
+		 **/
+		[[nodiscard]] bool is_using_delta_perception() const { return m_delta_perception != nullptr; }
+
 		/**
 		 * True is must run setup.
 		 * @return True is must run setup
@@ -176,7 +256,7 @@ namespace cam {
 		 * Receive a new message.
 		 * @param p_message The new message
 		 **/
-		void post(const MessagePointer& p_message);
+		void post(MessagePointer p_message);
 
 		/**
 		 * Send a new message by ID.
@@ -184,10 +264,21 @@ namespace cam {
 		 * @param p_message The message
 		 * @param p_length The message size
 		 **/
-		void
-		send(const std::string& p_receiver_id, const uint8_t* p_message = nullptr, const size_t& p_length = 0) const;
+		void send(const AgentId& p_receiver_id, const uint8_t* p_message = nullptr, const size_t& p_length = 0) const;
 
-		void send(const std::string& p_receiver_id, const json& p_message) const;
+		void send(const AgentId& p_receiver_id, const json& p_message) const;
+
+		/**
+		 * Send a typed message by ID. The object is moved to the receiver, which reads it with
+		 * Message::as<T>(), it is only converted to JSON if the receiver is remote.
+		 * @param p_receiver_id The id of the receiver
+		 * @param p_object The object, its type must be convertible to JSON
+		 **/
+		template<typename T>
+		requires std::is_constructible_v<json, const std::decay_t<T>&>
+		void send_object(const AgentId& p_receiver_id, T&& p_object) const {
+			send_object(p_receiver_id, MessageObject::create<std::decay_t<T>>(std::forward<T>(p_object)));
+		}
 
 		/**
 		 * Send a new message by name.
@@ -250,7 +341,7 @@ namespace cam {
 		 * @param p_first_only if true the first found
 		 * @return All agents by name
 		 **/
-		[[nodiscard]] std::vector<std::string>
+		[[nodiscard]] std::vector<AgentId>
 		get_agents_by_name(const std::string& p_name, bool p_first_only = false) const;
 
 		/**
@@ -258,14 +349,14 @@ namespace cam {
 		 * @param p_name the name of agent
 		 * @return All agents by name
 		 **/
-		[[nodiscard]] std::optional<std::string> get_first_agent_by_name(const std::string& p_name) const;
+		[[nodiscard]] std::optional<AgentId> get_first_agent_by_name(const std::string& p_name) const;
 
 		/**
 		 * Get agent name by id
 		 * @param p_id the name of agent
 		 * @return Agents name
 		 **/
-		[[nodiscard]] std::optional<std::string> get_agent_name(const std::string& p_id) const;
+		[[nodiscard]] std::optional<std::string> get_agent_name(const AgentId& p_id) const;
 
 		/**
 		 * Get all agents by fragment name
@@ -273,9 +364,48 @@ namespace cam {
 		 * @param p_first_only if true the first found
 		 * @return All agents by fragment name
 		 **/
-		[[nodiscard]] std::vector<std::string>
+		[[nodiscard]] std::vector<AgentId>
 		get_filtered_agents(const std::string& p_fragment_name, bool p_first_only = false) const;
 
+		/**
+		 * Get agent id by handle
+		 * @param p_handle the handle of agent
+		 * @return Agent id, empty if the handle is no longer valid
+		 **/
+		[[nodiscard]] std::optional<AgentId> get_agent_id(const AgentHandle& p_handle) const;
+
+		/**
+		 * Get a typed observable of this agent, as currently set
+		 * @param p_key Key of the observable (see Environment::register_observable)
+		 * @return The value, NaN if missing
+		 **/
+		[[nodiscard]] double get_observable(ObservableKey p_key) const;
+
+		/**
+		 * Get a typed observable of another agent, as it was at the start of the turn
+		 * @param p_handle Handle of the agent
+		 * @param p_key Key of the observable
+		 * @return The value, NaN if missing or if the handle is no longer valid
+		 **/
+		[[nodiscard]] double get_observable(const AgentHandle& p_handle, ObservableKey p_key) const;
+
+		/**
+		 * Get the other agents whose typed observable was in [p_min, p_max] at the start of the turn
+		 * @param p_key Key of the observable
+		 * @param p_min The min value
+		 * @param p_max The max value
+		 * @return Handles of the agents
+		 **/
+		[[nodiscard]] std::vector<AgentHandle> get_agents_in_range(ObservableKey p_key, double p_min,
+																   double p_max) const;
+
+		/**
+		 * Get the other agents whose typed observables matched a query at the start of the turn
+		 * @param p_query The query, e.g. ColumnQuery().where_within(x, y, 0, 0, 10)
+		 * @return Handles of the agents
+		 **/
+		[[nodiscard]] std::vector<AgentHandle> select_agents(const ColumnQuery& p_query) const;
+
 		/**
 		 * Perception filter.
 		 * @param p_observed Observed properties
@@ -294,12 +424,29 @@ namespace cam {
 		 **/
 		virtual void see(const std::vector<ObservablesPointer>& p_observable_agents);
 
+		/**
+		 * Compute see in delta perception mode, only called if the perception changed since the
+		 * previous turn.
+		 * @param p_added The agents perceived for the first time
+		 * @param p_changed The perceived agents whose observables changed
+		 * @param p_removed The agents no longer perceived (dead or filtered out), with their last observables
+		 **/
+		virtual void see_delta(std::span<const PerceivedAgent> p_added, std::span<const PerceivedAgent> p_changed,
+							   std::span<const PerceivedAgent> p_removed);
+
 		/**
 		 * Compute action.
 		 * @param p_message The message to compute
 		 **/
 		virtual void action(const MessagePointer& p_message);
 
+		/**
+		 * Compute action for all messages arrived, in order. Calls action for each message by default,
+		 * override it to process the inbox in bulk.
+		 * @param p_messages The messages to compute
+		 **/
+		virtual void action_batch(std::span<const MessagePointer> p_messages);
+
 		/**
 		 * Compute action if there is no message.
 		 **/
@@ -337,8 +484,8 @@ namespace cam {
 			for (const auto& l_observable: *m_observables) {
 				l_serialized_observables.emplace(l_observable.first, json::to_msgpack(l_observable.second));
 			}
-			p_archive(m_id, m_name, m_is_dead, m_is_setup, m_is_using_observables, m_messages,
-					  l_serialized_observables);
+			p_archive(m_id, m_name, m_is_dead, m_is_setup, m_is_using_observables, m_perception_radius,
+					  m_perception_query, is_using_delta_perception(), m_messages, l_serialized_observables);
 		}
 
 		/**
@@ -348,10 +495,12 @@ namespace cam {
 		template<class Archive>
 		void load(Archive& p_archive) {
 			std::unordered_map<std::string, std::vector<std::uint8_t>> l_serialized_observables;
-			p_archive(m_id, m_name, m_is_dead, m_is_setup, m_is_using_observables, m_messages,
-					  l_serialized_observables);
+			bool l_is_using_delta_perception;
+			p_archive(m_id, m_name, m_is_dead, m_is_setup, m_is_using_observables, m_perception_radius,
+					  m_perception_query, l_is_using_delta_perception, m_messages, l_serialized_observables);
+			set_delta_perception(l_is_using_delta_perception);
 			for (const auto& l_observable: l_serialized_observables) {
-				m_observables->emplace(l_observable.first, json::from_msgpack(l_observable.second));
+				edit_observables().emplace(l_observable.first, json::from_msgpack(l_observable.second));
 			}
 		}
 
@@ -367,6 +516,45 @@ namespace cam {
 		 */
 		explicit Agent();
 
+		/**
+		 * Get observables for writing. They are copied first if shared, so that the snapshot
+		 * perceived by the other agents during the turn never changes (copy-on-write).
+		 * @return Observables
+		 **/
+		Observables& edit_observables();
+
+		/**
+		 * Set a typed observable. The other agents see the new value from the next turn.
+		 * Typed observables belong to the environment: they are not serialized with the agent.
+		 * @param p_key Key of the observable (see Environment::register_observable)
+		 * @param p_value The value, NaN to remove it
+		 **/
+		void set_observable(ObservableKey p_key, double p_value);
+
+		/**
+		 * Enable delta perception: see_delta is called with the differences since the previous
+		 * turn instead of see with every perceived agent.
+		 * Only the agents whose observables changed are filtered again: call it again when
+		 * perception_filter selects other agents.
+		 * @param p_enabled True to enable
+		 **/
+		void set_delta_perception(bool p_enabled = true);
+
+		/**
+		 * Run the agent again even without messages (Reactive and Asynchronous modes): default_action
+		 * is called. Does nothing in the other modes, where every agent runs each turn.
+		 **/
+		void wake_up();
+
+		/**
+		 * Get the random stream of the agent. The stream of an agent created by another agent is
+		 * drawn from the stream of its creator, the other agents are numbered in the order they
+		 * are added: streams are reproducible in every mode when the agents created outside of
+		 * the agents are added by a single thread.
+		 * @return The random stream
+		 **/
+		RandomStream& get_random() { return m_random; }
+
 		/**
 		 * Get environment
 		 * @param p_archive archive to restore agent
@@ -385,6 +573,13 @@ namespace cam {
 		void internal_move(const std::stringstream& p_agent_stream, const json& p_message,
 						   const std::string& p_environment_id);
 
+		/**
+		 * Send the object of a typed message by ID.
+		 * @param p_receiver_id The id of the receiver
+		 * @param p_object The object
+		 **/
+		void send_object(const AgentId& p_receiver_id, ObjectPointer p_object) const;
+
 	private:
 
 		/**
@@ -392,6 +587,18 @@ namespace cam {
 		 * @param p_environment The environment
 		 **/
 		void set_environment(Environment* p_environment) { m_environment = p_environment; }
+
+		/**
+		 * Add the agent to the ready agents of the environment, unless already there, or schedule it
+		 * again when its run ends (Reactive and Asynchronous modes).
+		 **/
+		void schedule();
+
+		/**
+		 * Get the agent run by the calling thread.
+		 * @return The agent, null outside of the agents
+		 **/
+		static Agent* get_running_agent();
 	};
 
 	// Agent pointer
@@ -18,16 +18,62 @@
 
 #include "AgentCollection.h"
 
-#include <future>
-#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
 
 #include "Environment.h"
 
+namespace {
+	/**
+	 * No shard is running on this thread
+	 */
+	constexpr size_t s_no_shard = std::numeric_limits<size_t>::max();
+
+	/**
+	 * Shard run by this thread, agents created by an agent may join the shard of their creator
+	 * (see set_creator_shard)
+	 */
+	thread_local size_t t_running_shard = s_no_shard;
+
+	/**
+	 * No asynchronous worker is running on this thread
+	 */
+	constexpr size_t s_no_async_worker = std::numeric_limits<size_t>::max();
+
+	/**
+	 * Asynchronous worker run by this thread, agents scheduled by an agent are run by the same worker
+	 */
+	thread_local size_t t_running_async_worker = s_no_async_worker;
+}
+
 cam::AgentCollection::AgentCollection(const EnvironmentMasMode& p_environment_mas_mode, const unsigned int p_seed) :
+		m_next_shard(0),
+		m_is_using_creator_shard(false),
+		m_has_stopped_agents(false),
+		m_observing_agent_count(0),
+		m_chunk_size(0),
+		m_next_async_worker(0),
+		m_async_scheduled_count(0),
+		m_async_run_count(0),
+		m_async_parked_count(0),
+		m_async_wake_count(0),
+		m_is_snapshot_outdated(true),
 		m_pool(std::thread::hardware_concurrency() == 0 ? 8 : std::thread::hardware_concurrency()),
 		m_environment_mas_mode(p_environment_mas_mode),
-		m_seed(p_seed) {
-
+		m_seed(p_seed),
+		m_random(p_seed),
+		m_stream_count(0),
+		m_grain_size(0),
+		m_agent_run_time(0) {
+	set_shard_count(1);
+	if (m_environment_mas_mode == EnvironmentMasMode::Asynchronous) {
+		for (size_t l_index = 0; l_index < m_pool.get_number_of_threads(); l_index++) {
+			m_async_workers.push_back(std::make_unique<AsyncWorker>());
+		}
+	}
 }
 
 size_t cam::AgentCollection::count() const {
@@ -35,139 +81,612 @@ size_t cam::AgentCollection::count() const {
 }
 
 void cam::AgentCollection::add(const AgentPointer& p_agent) {
-	m_new_agents.enqueue(p_agent);
+	// Drawn in the order of the code of the creator, whatever the order of insertion
+	if (Agent* l_creator = Agent::get_running_agent(); l_creator) {
+		p_agent->m_random = RandomStream(m_seed, l_creator->m_random());
+	} else {
+		p_agent->m_random = RandomStream(m_seed, m_stream_count.fetch_add(1, std::memory_order_relaxed) + 1);
+	}
+	place(p_agent);
+}
+
+void cam::AgentCollection::place(const AgentPointer& p_agent) {
+	size_t l_shard = t_running_shard;
+	if (!m_is_using_creator_shard || l_shard >= m_shards.size()) {
+		l_shard = m_next_shard.fetch_add(1, std::memory_order_relaxed) % m_shards.size();
+	}
+	m_shards[l_shard]->m_new_agents.enqueue(p_agent);
+}
+
+void cam::AgentCollection::set_shard_count(const size_t p_shard_count) {
+	std::vector<AgentPointer> l_new_agents;
+	for (const auto& l_shard: m_shards) {
+		l_shard->m_new_agents.drain([&l_new_agents](AgentPointer&& p_agent) {
+			l_new_agents.push_back(std::move(p_agent));
+		});
+	}
+
+	m_shards.clear();
+	for (size_t l_index = 0; l_index < std::max<size_t>(1, p_shard_count); l_index++) {
+		m_shards.push_back(std::make_unique<Shard>());
+	}
+	balance_shards(true);
+	m_next_shard = 0;
+	for (const AgentPointer& l_agent: l_new_agents) {
+		place(l_agent);
+	}
 }
 
 const cam::AgentPointer& cam::AgentCollection::random_agent() const {
-	auto l_it = m_agents.begin();
-	do {
+	static const AgentPointer s_no_agent;
+
+	std::lock_guard l_lock(m_alive_mutex);
+	if (m_alive_agents.empty()) {
+		return s_no_agent;
+	}
+	return m_agents[m_alive_agents[get_random_value(0, m_alive_agents.size() - 1)]];
+}
+
+std::vector<cam::AgentPointer> cam::AgentCollection::random_agents(const size_t p_count) const {
+	std::lock_guard l_lock(m_alive_mutex);
+	const size_t l_count = std::min(p_count, m_alive_agents.size());
+	std::vector<AgentPointer> l_agents;
+	l_agents.reserve(l_count);
 
-		std::advance(l_it, get_random_value(0, m_agents.size()));
-	} while (l_it->second->is_dead());
-	return l_it->second;
+	// Partial Fisher-Yates: the first l_count alive agents become the sample
+	for (size_t l_index = 0; l_index < l_count; l_index++) {
+		const size_t l_other_index = get_random_value(l_index, m_alive_agents.size() - 1);
+		std::swap(m_alive_agents[l_index], m_alive_agents[l_other_index]);
+		m_alive_positions[m_alive_agents[l_index]] = static_cast<std::uint32_t>(l_index);
+		m_alive_positions[m_alive_agents[l_other_index]] = static_cast<std::uint32_t>(l_other_index);
+		l_agents.push_back(m_agents[m_alive_agents[l_index]]);
+	}
+	return l_agents;
+}
+
+void cam::AgentCollection::set_stopped(const AgentHandle& p_handle) {
+	if (!contains(p_handle)) {
+		return;
+	}
+	const std::uint32_t l_dense_index = m_slots[p_handle.m_slot].m_dense_index;
+	std::lock_guard l_lock(m_alive_mutex);
+	const std::uint32_t l_position = m_alive_positions[l_dense_index];
+	if (l_position == s_not_alive) {
+		return;
+	}
+	m_alive_agents[l_position] = m_alive_agents.back();
+	m_alive_positions[m_alive_agents[l_position]] = l_position;
+	m_alive_agents.pop_back();
+	m_alive_positions[l_dense_index] = s_not_alive;
+	m_has_stopped_agents = true;
 }
 
 bool cam::AgentCollection::contains(const AgentPointer& p_agent) const {
-	return m_agents.contains(p_agent->get_id());
+	return get(p_agent->get_handle()) == p_agent;
+}
+
+bool cam::AgentCollection::contains(const AgentId& p_id) const {
+	return m_handles.contains(p_id);
 }
 
-bool cam::AgentCollection::contains(const std::string& p_id) const {
-	return m_agents.contains(p_id);
+bool cam::AgentCollection::is_reactive() const {
+	return m_environment_mas_mode == EnvironmentMasMode::Reactive ||
+		   m_environment_mas_mode == EnvironmentMasMode::Asynchronous;
 }
 
-void cam::AgentCollection::remove(const std::string& p_id) {
-	if (contains(p_id)) {
-		m_agents.erase(p_id);
+void cam::AgentCollection::schedule(const AgentHandle& p_handle) {
+	if (m_async_workers.empty()) {
+		m_ready_agents.enqueue(p_handle);
+		return;
+	}
+	m_async_scheduled_count.fetch_add(1, std::memory_order_relaxed);
+	if (const size_t l_worker = t_running_async_worker; l_worker < m_async_workers.size()) {
+		m_async_workers[l_worker]->m_ready_agents.enqueue(p_handle);
+		return;
+	}
+
+	// From outside the workers: the chosen worker may be idle
+	const size_t l_worker = m_next_async_worker.fetch_add(1, std::memory_order_relaxed) % m_async_workers.size();
+	m_async_workers[l_worker]->m_ready_agents.enqueue(p_handle);
+	wake_async_workers();
+}
+
+void cam::AgentCollection::remove(const AgentId& p_id) {
+	if (const AgentPointer& l_agent = get(p_id); l_agent) {
+		l_agent->stop();
 	}
 }
 
 void cam::AgentCollection::run_turn() {
 	// Sequential
 	if (m_environment_mas_mode == EnvironmentMasMode::Sequential) {
-		for (auto& [l_agent_id, l_agent]: m_agents) {
+		for (const AgentPointer& l_agent: m_agents) {
 			l_agent->run_turn();
 		}
 
-		// Random
-	} else {
-		const auto m_parallel = m_environment_mas_mode == EnvironmentMasMode::Parallel;
-		std::vector<std::future<void>> l_asyncs;
-		const std::vector<std::string> l_agents = get_ids();
-		const auto l_count = l_agents.size();
-		const std::vector<int> l_agent_order = random_permutation(l_count);
-		size_t l_index = 0;
-
-		while (l_index < l_count) {
-			const std::string& l_agent_id = l_agents.at(l_agent_order.at(l_index++));
-			if (AgentPointer l_agent = get(l_agent_id); l_agent) {
-				if (m_parallel) {
-					l_asyncs.push_back(m_pool.addWorkFunc([l_agent] {
-						l_agent->run_turn();
-					}));
-				} else {
-					l_agent->run_turn();
-				}
+		// Parallel: each shard by its own worker
+	} else if (m_environment_mas_mode == EnvironmentMasMode::Parallel && m_shards.size() > 1) {
+		m_pool.parallel_for_pinned(m_shards.size(), [this](const size_t p_shard) {
+			t_running_shard = p_shard;
+			for (size_t l_index = m_shards[p_shard]->m_begin; l_index < m_shards[p_shard]->m_end; l_index++) {
+				m_agents[l_index]->run_turn();
+			}
+			t_running_shard = s_no_shard;
+		});
 
+		// Parallel: contiguous ranges of agents per task
+	} else if (m_environment_mas_mode == EnvironmentMasMode::Parallel) {
+		const auto l_count = m_agents.size();
+		std::atomic<int64_t> l_run_time = 0;
+
+		m_pool.parallel_for(0, l_count, get_grain_size(l_count),
+							[this, &l_run_time](const size_t p_begin, const size_t p_end) {
+			const auto& l_start_time = std::chrono::steady_clock::now();
+			for (size_t l_index = p_begin; l_index < p_end; l_index++) {
+				m_agents[l_index]->run_turn();
 			}
+			l_run_time.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - l_start_time).count(), std::memory_order_relaxed);
+		});
+
+		// Smooth the measure, a single turn may be disturbed (setup, mass sending...)
+		if (l_count > 0) {
+			const double l_agent_run_time = static_cast<double>(l_run_time.load()) / static_cast<double>(l_count);
+			m_agent_run_time = m_agent_run_time == 0 ? l_agent_run_time : (m_agent_run_time + l_agent_run_time) / 2;
 		}
-		for (std::future<void>& l_async: l_asyncs) {
-			l_async.wait();
+
+		// Reactive: only the agents scheduled before the turn, the others wait for the next one
+	} else if (m_environment_mas_mode == EnvironmentMasMode::Reactive) {
+		m_scheduled_agents.clear();
+		m_ready_agents.drain([this](AgentHandle&& p_handle) { m_scheduled_agents.push_back(p_handle); });
+		const auto l_count = m_scheduled_agents.size();
+		m_pool.parallel_for(0, l_count, get_grain_size(l_count), [this](const size_t p_begin, const size_t p_end) {
+			for (size_t l_index = p_begin; l_index < p_end; l_index++) {
+				run_scheduled_agent(m_scheduled_agents[l_index]);
+			}
+		});
+
+		// Asynchronous: agents are run as soon as they are scheduled, the turn only ends for new agents
+	} else if (m_environment_mas_mode == EnvironmentMasMode::Asynchronous) {
+		const size_t l_turn_length = std::max(m_agents.size(), s_min_async_turn_length);
+		m_async_run_count.store(0, std::memory_order_relaxed);
+		m_pool.parallel_for_pinned(m_async_workers.size(), [this, l_turn_length](const size_t p_worker) {
+			t_running_async_worker = p_worker;
+			run_async_worker(p_worker, l_turn_length);
+			t_running_async_worker = s_no_async_worker;
+		});
+
+		// Random
+	} else {
+		shuffle_agent_order();
+		for (const std::uint32_t l_index: m_agent_order) {
+			m_agents[l_index]->run_turn();
 		}
 	}
 }
 
 void cam::AgentCollection::process_buffers() {
-	// Remove dead agents
-	std::vector<std::string> l_ids;
-	l_ids.reserve(m_agents.size());
-	for (auto& [l_id, l_agent]: m_agents) {
-		if (l_agent->is_dead()) {
-			l_ids.push_back(l_id);
-			const auto [l_start, l_end] = m_agents_by_name.equal_range(l_agent->get_name());
-			for (auto l_agent_it = l_start; l_agent_it != l_end; ++l_agent_it) {
-				if (l_agent_it->second == l_id) {
-					m_agents_by_name.erase(l_agent_it);
-					break;
+	// Mark: collect the dead and new agents, in parallel
+	bool l_has_stopped_agents;
+	{
+		std::lock_guard l_lock(m_alive_mutex);
+		l_has_stopped_agents = m_has_stopped_agents;
+		m_has_stopped_agents = false;
+	}
+	if (m_shards.size() == 1) {
+		if (l_has_stopped_agents) {
+			collect_dead_agents();
+		}
+		Shard& l_shard = *m_shards.front();
+		l_shard.m_new_agents.drain([&l_shard](AgentPointer&& p_agent) {
+			l_shard.m_added_agents.push_back(std::move(p_agent));
+		});
+	} else {
+		m_pool.parallel_for_pinned(m_shards.size(), [this, l_has_stopped_agents](const size_t p_shard) {
+			Shard& l_shard = *m_shards[p_shard];
+			for (size_t l_index = l_shard.m_begin; l_has_stopped_agents && l_index < l_shard.m_end; l_index++) {
+				if (m_agents[l_index]->is_dead()) {
+					l_shard.m_dead_agents.push_back(m_agents[l_index].get());
 				}
 			}
+			l_shard.m_new_agents.drain([&l_shard](AgentPointer&& p_agent) {
+				l_shard.m_added_agents.push_back(std::move(p_agent));
+			});
+		});
+	}
+
+	// Update the indexes of the changed agents only, each name is compacted once
+	bool l_is_changed = false;
+	for (const auto& l_shard: m_shards) {
+		for (const Agent* l_agent: l_shard->m_dead_agents) {
+			m_names.mark(l_agent->get_name());
+			m_handles.erase(l_agent->get_id());
+		}
+		l_is_changed |= !l_shard->m_dead_agents.empty();
+	}
+	m_names.compact([this](const AgentHandle& p_handle) {
+		return m_agents[m_slots[p_handle.m_slot].m_dense_index]->is_dead();
+	});
+	for (const auto& l_shard: m_shards) {
+		for (Agent* l_agent: l_shard->m_dead_agents) {
+			m_slots[l_agent->m_handle.m_slot].m_generation++;
+			m_free_slots.push_back(l_agent->m_handle.m_slot);
+			m_observable_columns.reset(l_agent->m_handle.m_slot);
+			m_observing_agent_count -= l_agent->is_using_observables();
+			l_agent->m_handle = AgentHandle();
+		}
+	}
+	for (const auto& l_shard: m_shards) {
+		std::erase_if(l_shard->m_added_agents, [this](const AgentPointer& p_agent) {
+			if (m_handles.contains(p_agent->get_id())) {
+				return true;
+			}
+			std::uint32_t l_slot_index;
+			if (m_free_slots.empty()) {
+				l_slot_index = static_cast<std::uint32_t>(m_slots.size());
+				m_slots.push_back({0, 0});
+			} else {
+				l_slot_index = m_free_slots.back();
+				m_free_slots.pop_back();
+			}
+			p_agent->m_handle = {l_slot_index, m_slots[l_slot_index].m_generation};
+			if (p_agent->is_dead()) {
+				// Stopped before being added, removed by the next process_buffers
+				m_has_stopped_agents = true;
+			}
+			if (is_reactive()) {
+				// Runs setup on the next turn, messages posted before insertion had no valid handle
+				p_agent->m_schedule_state.store(Agent::ScheduleState::Scheduled, std::memory_order_relaxed);
+				schedule(p_agent->m_handle);
+			}
+			m_handles.emplace(p_agent->get_id(), p_agent->m_handle);
+			m_names.insert(p_agent->get_name(), p_agent->get_id(), p_agent->m_handle);
+			m_observing_agent_count += p_agent->is_using_observables();
+			return false;
+		});
+		l_is_changed |= !l_shard->m_added_agents.empty();
+	}
+	if (!l_is_changed) {
+		return;
+	}
+	set_snapshot_outdated();
+	m_observable_columns.resize(m_slots.size());
+
+	// Single shard without dead agent: nothing to compact
+	if (Shard& l_shard = *m_shards.front(); m_shards.size() == 1 && l_shard.m_dead_agents.empty()) {
+		for (AgentPointer& l_agent: l_shard.m_added_agents) {
+			m_slots[l_agent->m_handle.m_slot].m_dense_index = static_cast<std::uint32_t>(m_agents.size());
+			m_agents.push_back(std::move(l_agent));
 		}
+		l_shard.m_end = m_agents.size();
+		l_shard.m_added_agents.clear();
+		update_alive_agents();
+		return;
 	}
 
-	for (const auto& l_id: l_ids) {
-		remove(l_id);
+	// New layout: alive agents then new agents, shard by shard
+	size_t l_count = 0;
+	for (const auto& l_shard: m_shards) {
+		l_shard->m_next_begin = l_count;
+		l_count += l_shard->m_end - l_shard->m_begin - l_shard->m_dead_agents.size() + l_shard->m_added_agents.size();
 	}
+	m_next_agents.resize(l_count);
 
-	// Add new agents
-	if (AgentPointer l_agent; m_new_agents.dequeue(l_agent)) {
-		do {
-			m_agents.insert(std::make_pair(l_agent->get_id(), l_agent));
-			m_agents_by_name.insert(std::make_pair(l_agent->get_name(), l_agent->get_id()));
-		} while (m_new_agents.dequeue(l_agent));
+	// Compact: single pass moving the agents to the new layout, in parallel
+	const auto& l_move = [this](const size_t p_shard) {
+		Shard& l_shard = *m_shards[p_shard];
+		size_t l_next_index = l_shard.m_next_begin;
+		if (m_shards.size() == 1) {
+			l_next_index = move_alive_agents();
+		} else if (!l_shard.m_dead_agents.empty()) {
+			l_next_index = move_alive_agents(l_shard.m_begin, l_shard.m_end, l_next_index);
+		} else {
+			for (size_t l_index = l_shard.m_begin; l_index < l_shard.m_end; l_index++) {
+				move_agent(m_agents[l_index], l_next_index++);
+			}
+		}
+		for (AgentPointer& l_agent: l_shard.m_added_agents) {
+			move_agent(l_agent, l_next_index++);
+		}
+		l_shard.m_begin = l_shard.m_next_begin;
+		l_shard.m_end = l_next_index;
+		l_shard.m_dead_agents.clear();
+		l_shard.m_added_agents.clear();
+	};
+	if (m_shards.size() == 1) {
+		l_move(0);
+	} else {
+		m_pool.parallel_for_pinned(m_shards.size(), l_move);
 	}
+	m_agents.swap(m_next_agents);
+	m_next_agents.clear();
+	balance_shards();
+	update_alive_agents();
 }
 
-cam::AgentPointer cam::AgentCollection::get(const std::string& p_id) const {
-	const auto& l_it = m_agents.find(p_id);
-	return l_it == m_agents.end() ? nullptr : l_it->second;
+void cam::AgentCollection::balance_shards(const bool p_is_forced) {
+	const size_t l_shard_count = m_shards.size();
+	if (!p_is_forced) {
+		size_t l_min_size = std::numeric_limits<size_t>::max();
+		size_t l_max_size = 0;
+		for (const auto& l_shard: m_shards) {
+			l_min_size = std::min(l_min_size, l_shard->m_end - l_shard->m_begin);
+			l_max_size = std::max(l_max_size, l_shard->m_end - l_shard->m_begin);
+		}
+		if ((l_max_size - l_min_size) * s_shard_imbalance <= m_agents.size() / l_shard_count) {
+			return;
+		}
+	}
+	for (size_t l_index = 0; l_index < l_shard_count; l_index++) {
+		m_shards[l_index]->m_begin = m_agents.size() * l_index / l_shard_count;
+		m_shards[l_index]->m_end = m_agents.size() * (l_index + 1) / l_shard_count;
+	}
 }
 
-std::vector<std::string> cam::AgentCollection::get_ids(const bool p_alive_only) {
-	std::vector<std::string> l_result;
-	l_result.reserve(m_agents.size());
+void cam::AgentCollection::update_alive_agents() {
+	m_alive_agents.clear();
+	m_alive_positions.assign(m_agents.size(), s_not_alive);
+	for (size_t l_index = 0; l_index < m_agents.size(); l_index++) {
+		if (!m_agents[l_index]->is_dead()) {
+			m_alive_positions[l_index] = static_cast<std::uint32_t>(m_alive_agents.size());
+			m_alive_agents.push_back(static_cast<std::uint32_t>(l_index));
+		}
+	}
+}
 
-	for (auto& [l_id, l_agent]: m_agents) {
-		if (!p_alive_only || !l_agent->is_dead()) {
-			l_result.push_back(l_id);
+void cam::AgentCollection::run_scheduled_agent(const AgentHandle& p_handle) {
+	if (!contains(p_handle)) {
+		return;
+	}
+	Agent& l_agent = *m_agents[m_slots[p_handle.m_slot].m_dense_index];
+	l_agent.m_schedule_state.exchange(Agent::ScheduleState::Running, std::memory_order_acq_rel);
+
+	// Perception queries are usually set by setup
+	if (!l_agent.is_setup()) {
+		set_snapshot_outdated();
+	}
+	l_agent.run_turn();
+
+	// Scheduled while running: run again. Otherwise, messages may be left by the setup turn
+	if (Agent::ScheduleState l_state = Agent::ScheduleState::Running;
+			!l_agent.m_schedule_state.compare_exchange_strong(l_state, Agent::ScheduleState::Idle,
+															  std::memory_order_acq_rel)) {
+		l_agent.m_schedule_state.store(Agent::ScheduleState::Scheduled, std::memory_order_release);
+		schedule(p_handle);
+	} else if (!l_agent.is_dead() && !l_agent.m_messages.empty()) {
+		l_agent.schedule();
+	}
+}
+
+void cam::AgentCollection::run_async_worker(const size_t p_worker, const size_t p_turn_length) {
+	AsyncWorker& l_worker = *m_async_workers[p_worker];
+	const auto& l_is_turn_running = [this, p_turn_length] {
+		return m_async_scheduled_count.load(std::memory_order_acquire) != 0 &&
+			   m_async_run_count.load(std::memory_order_relaxed) < p_turn_length;
+	};
+	while (l_is_turn_running()) {
+		// Idle: wait for agents, checking again once registered to not miss a wake up
+		if (!take_async_agents(p_worker)) {
+			const std::uint32_t l_wake_count = m_async_wake_count.load(std::memory_order_acquire);
+			m_async_parked_count.fetch_add(1, std::memory_order_seq_cst);
+			const bool l_has_agents = take_async_agents(p_worker);
+			if (!l_has_agents && l_is_turn_running()) {
+				m_async_wake_count.wait(l_wake_count, std::memory_order_acquire);
+			}
+			m_async_parked_count.fetch_sub(1, std::memory_order_relaxed);
+			if (!l_has_agents) {
+				continue;
+			}
 		}
+
+		// Agents scheduled by these runs are counted before these ones are released
+		for (const AgentHandle& l_handle: l_worker.m_agents) {
+			run_scheduled_agent(l_handle);
+		}
+		m_async_run_count.fetch_add(l_worker.m_agents.size(), std::memory_order_relaxed);
+		m_async_scheduled_count.fetch_sub(l_worker.m_agents.size(), std::memory_order_acq_rel);
 	}
 
-	return l_result;
+	// Release the idle workers at the end of the turn
+	wake_async_workers();
 }
 
-std::vector<int> cam::AgentCollection::random_permutation(const size_t p_number) const {
-	std::vector<int> l_numbers(p_number);
-	for (size_t l_index = 0; l_index < p_number; l_index++) {
-		l_numbers[l_index] = static_cast<int>(l_index);
+bool cam::AgentCollection::take_async_agents(const size_t p_worker) {
+	AsyncWorker& l_worker = *m_async_workers[p_worker];
+	l_worker.m_agents.clear();
+
+	// Agents of this worker: the ones it does not run now can be stolen
+	size_t l_left_count;
+	{
+		std::lock_guard l_lock(l_worker.m_mutex);
+		l_worker.m_ready_agents.drain([&l_worker](AgentHandle&& p_handle) {
+			l_worker.m_stealable_agents.push_back(p_handle);
+		});
+		const size_t l_count = std::min(l_worker.m_stealable_agents.size() - l_worker.m_head, s_async_batch_size);
+		l_worker.m_agents.assign(l_worker.m_stealable_agents.begin() + static_cast<std::ptrdiff_t>(l_worker.m_head),
+								 l_worker.m_stealable_agents.begin() +
+								 static_cast<std::ptrdiff_t>(l_worker.m_head + l_count));
+		l_worker.m_head += l_count;
+		l_left_count = l_worker.m_stealable_agents.size() - l_worker.m_head;
+		if (l_left_count == 0) {
+			l_worker.m_stealable_agents.clear();
+			l_worker.m_head = 0;
+		}
+	}
+	if (!l_worker.m_agents.empty()) {
+		if (l_left_count != 0) {
+			wake_async_workers();
+		}
+		return true;
 	}
 
-	size_t l_index = p_number - 1;
-	while (l_index > 1) {
-		const size_t l_k = get_random_value(0, l_index);
-		if (l_k == l_index) {
+	// Otherwise steal half of the agents of another worker
+	for (size_t l_offset = 1; l_offset < m_async_workers.size(); l_offset++) {
+		AsyncWorker& l_victim = *m_async_workers[(p_worker + l_offset) % m_async_workers.size()];
+		std::lock_guard l_lock(l_victim.m_mutex);
+		const size_t l_count = (l_victim.m_stealable_agents.size() - l_victim.m_head + 1) / 2;
+		if (l_count == 0) {
 			continue;
 		}
-		const int l_temp = l_numbers[l_index];
-		l_numbers[l_index] = l_numbers[l_k];
-		l_numbers[l_k] = l_temp;
-		l_index--;
+		l_worker.m_agents.assign(l_victim.m_stealable_agents.end() - static_cast<std::ptrdiff_t>(l_count),
+								 l_victim.m_stealable_agents.end());
+		l_victim.m_stealable_agents.resize(l_victim.m_stealable_agents.size() - l_count);
+		if (l_victim.m_head == l_victim.m_stealable_agents.size()) {
+			l_victim.m_stealable_agents.clear();
+			l_victim.m_head = 0;
+		}
+		return true;
+	}
+	return false;
+}
+
+void cam::AgentCollection::wake_async_workers() {
+	// Pairs with the registration of an idle worker before it checks for agents again
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_async_parked_count.load(std::memory_order_relaxed) != 0) {
+		m_async_wake_count.fetch_add(1, std::memory_order_release);
+		m_async_wake_count.notify_all();
+	}
+}
+
+void cam::AgentCollection::collect_dead_agents() {
+	// A chunk should be long enough to hide the scheduling cost
+	static constexpr size_t s_min_chunk_size = 16384;
+
+	const size_t l_count = m_agents.size();
+	const size_t l_number_of_threads = m_pool.get_number_of_threads();
+	m_chunk_size = std::max(s_min_chunk_size, (l_count + l_number_of_threads - 1) / l_number_of_threads);
+	m_chunk_dead_agents.resize((l_count + m_chunk_size - 1) / m_chunk_size);
+	m_pool.parallel_for(0, l_count, m_chunk_size, [this](const size_t p_begin, const size_t p_end) {
+		std::vector<Agent*>& l_dead_agents = m_chunk_dead_agents[p_begin / m_chunk_size];
+		l_dead_agents.clear();
+		for (size_t l_index = p_begin; l_index < p_end; l_index++) {
+			if (m_agents[l_index]->is_dead()) {
+				l_dead_agents.push_back(m_agents[l_index].get());
+			}
+		}
+	});
+
+	// In order
+	std::vector<Agent*>& l_dead_agents = m_shards.front()->m_dead_agents;
+	for (const std::vector<Agent*>& l_chunk_dead_agents: m_chunk_dead_agents) {
+		l_dead_agents.insert(l_dead_agents.end(), l_chunk_dead_agents.begin(), l_chunk_dead_agents.end());
+	}
+}
+
+size_t cam::AgentCollection::move_alive_agents() {
+	// Each chunk starts after the alive agents of the previous ones
+	std::vector<size_t> l_chunk_next_indexes(m_chunk_dead_agents.size());
+	size_t l_next_index = 0;
+	for (size_t l_chunk = 0; l_chunk < m_chunk_dead_agents.size(); l_chunk++) {
+		l_chunk_next_indexes[l_chunk] = l_next_index;
+		l_next_index += std::min(m_chunk_size, m_agents.size() - l_chunk * m_chunk_size) -
+						m_chunk_dead_agents[l_chunk].size();
+	}
+	m_pool.parallel_for(0, m_agents.size(), m_chunk_size,
+						[this, &l_chunk_next_indexes](const size_t p_begin, const size_t p_end) {
+		const size_t l_chunk = p_begin / m_chunk_size;
+		if (m_chunk_dead_agents[l_chunk].empty()) {
+			for (size_t l_index = p_begin; l_index < p_end; l_index++) {
+				move_agent(m_agents[l_index], l_chunk_next_indexes[l_chunk] + l_index - p_begin);
+			}
+		} else {
+			move_alive_agents(p_begin, p_end, l_chunk_next_indexes[l_chunk]);
+		}
+		m_chunk_dead_agents[l_chunk].clear();
+	});
+	return l_next_index;
+}
+
+size_t cam::AgentCollection::move_alive_agents(const size_t p_begin, const size_t p_end, size_t p_next_index) {
+	for (size_t l_index = p_begin; l_index < p_end; l_index++) {
+		if (!m_agents[l_index]->is_dead()) {
+			move_agent(m_agents[l_index], p_next_index++);
+		}
+	}
+	return p_next_index;
+}
+
+size_t cam::AgentCollection::get_grain_size(const size_t p_count) const {
+	// A task should last long enough to hide the scheduling cost
+	static constexpr double s_task_run_time = 50000; // ns
+
+	if (m_grain_size != 0) {
+		return m_grain_size;
+	}
+	const size_t l_number_of_threads = m_pool.get_number_of_threads();
+	const size_t l_max_grain = std::max<size_t>(1, (p_count + l_number_of_threads - 1) / l_number_of_threads);
+	if (m_agent_run_time == 0) {
+		return std::max<size_t>(1, p_count / (l_number_of_threads * 8));
+	}
+	const auto l_grain = static_cast<size_t>(std::ceil(s_task_run_time / m_agent_run_time));
+	return std::clamp<size_t>(l_grain, 1, l_max_grain);
+}
+
+cam::AgentPointer cam::AgentCollection::get(const AgentId& p_id) const {
+	const auto& l_it = m_handles.find(p_id);
+	return l_it == m_handles.end() ? nullptr : get(l_it->second);
+}
+
+cam::AgentPointer cam::AgentCollection::get(const AgentHandle& p_handle) const {
+	if (p_handle.m_slot >= m_slots.size()) {
+		return nullptr;
+	}
+	const AgentSlot& l_slot = m_slots[p_handle.m_slot];
+	return l_slot.m_generation == p_handle.m_generation ? m_agents[l_slot.m_dense_index] : nullptr;
+}
+
+std::span<const cam::AgentId> cam::AgentCollection::get_by_name(const std::string& p_name) const {
+	return m_names.find(p_name);
+}
+
+std::span<const cam::AgentHandle> cam::AgentCollection::get_handles_by_name(const std::string& p_name) const {
+	return m_names.find_handles(p_name);
+}
+
+std::vector<cam::AgentId> cam::AgentCollection::get_by_fragment_name(const std::string& p_fragment_name) const {
+	std::vector<std::pair<std::uint32_t, AgentId>> l_matches;
+	m_names.for_each_fragment(p_fragment_name, [this, &l_matches](const std::span<const AgentId> p_agents,
+																  const std::span<const AgentHandle> p_handles) {
+		for (size_t l_index = 0; l_index < p_agents.size(); l_index++) {
+			l_matches.emplace_back(m_slots[p_handles[l_index].m_slot].m_dense_index, p_agents[l_index]);
+		}
+	});
+
+	// Names are not visited in insertion order
+	std::ranges::sort(l_matches, {}, &std::pair<std::uint32_t, AgentId>::first);
+	std::vector<AgentId> l_result;
+	l_result.reserve(l_matches.size());
+	for (const auto& [l_dense_index, l_id]: l_matches) {
+		l_result.push_back(l_id);
+	}
+	return l_result;
+}
+
+std::vector<cam::AgentId> cam::AgentCollection::get_ids(const bool p_alive_only) {
+	std::vector<AgentId> l_result;
+	l_result.reserve(m_agents.size());
+
+	for (const AgentPointer& l_agent: m_agents) {
+		if (!p_alive_only || !l_agent->is_dead()) {
+			l_result.push_back(l_agent->get_id());
+		}
 	}
 
-	return l_numbers;
+	return l_result;
+}
+
+void cam::AgentCollection::shuffle_agent_order() {
+	const size_t l_count = m_agents.size();
+	if (m_agent_order.size() != l_count) {
+		m_agent_order.resize(l_count);
+		std::iota(m_agent_order.begin(), m_agent_order.end(), 0);
+	}
+	for (size_t l_index = l_count; l_index > 1; l_index--) {
+		std::swap(m_agent_order[l_index - 1], m_agent_order[get_random_value(0, l_index - 1)]);
+	}
 }
 
 size_t cam::AgentCollection::get_random_value(const size_t& p_min, const size_t& p_max) const {
-	static std::default_random_engine s_seeder(m_seed);
-	static std::mt19937 s_generator(s_seeder());
-	std::uniform_int_distribution<size_t> l_dist(p_min, p_max);
-	return l_dist(s_generator);
+	return static_cast<size_t>(m_random.uniform_int(p_min, p_max));
 }
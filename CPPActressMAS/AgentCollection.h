@@ -18,9 +18,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include "Agent.h"
-#include "ThreadPool/ThreadPool.h"
-#include "tsl/ordered_map.h"
+#include "NameIndex.h"
+#include "ObservableColumns.h"
+#include "RandomStream.hpp"
+#include "WorkStealingPool.hpp"
 
 /**
  * CPPActressMAS
@@ -35,26 +43,221 @@ namespace cam {
 	class AgentCollection final {
 		friend Environment;
 
+		/**
+		 * Slot of an agent: position in the dense storage
+		 **/
+		struct AgentSlot {
+			std::uint32_t m_dense_index;
+			std::uint32_t m_generation;
+		};
+
+		/**
+		 * Partition of the agents, run by the same worker every turn in parallel mode
+		 **/
+		struct alignas(64) Shard {
+			/**
+			 * Agents of the shard: [m_begin, m_end) in m_agents, in insertion order
+			 **/
+			size_t m_begin;
+			size_t m_end;
+
+			/**
+			 * Position of the shard after processing buffers
+			 **/
+			size_t m_next_begin;
+
+			/**
+			 * New agent buffer
+			 **/
+			MPSCQueue<AgentPointer> m_new_agents;
+
+			/**
+			 * Agents added and removed by the current process_buffers
+			 **/
+			std::vector<AgentPointer> m_added_agents;
+			std::vector<Agent*> m_dead_agents;
+		};
+
+		/**
+		 * Worker of the asynchronous mode
+		 **/
+		struct alignas(64) AsyncWorker {
+			/**
+			 * Agents scheduled by this worker (or from outside the workers)
+			 **/
+			MPSCQueue<AgentHandle> m_ready_agents;
+
+			/**
+			 * Ready agents of this worker, run from the front and stolen from the back by idle workers
+			 **/
+			std::mutex m_mutex;
+			std::vector<AgentHandle> m_stealable_agents;
+			size_t m_head = 0;
+
+			/**
+			 * Agents being run (reused)
+			 **/
+			std::vector<AgentHandle> m_agents;
+		};
+
+		/**
+		 * Asynchronous mode: minimum number of agent runs of a turn, to hide the cost of the barrier
+		 **/
+		static constexpr size_t s_min_async_turn_length = 1024;
+
+		/**
+		 * Asynchronous mode: maximum number of agents a worker takes from its own ready agents at once
+		 **/
+		static constexpr size_t s_async_batch_size = 32;
+
 	protected:
 		/**
-		 * Agents: id, content
+		 * Agents, contiguous, shard by shard and in insertion order
+		 **/
+		std::vector<AgentPointer> m_agents;
+
+		/**
+		 * Agents being moved by process_buffers (reused across turns)
+		 **/
+		std::vector<AgentPointer> m_next_agents;
+
+		/**
+		 * Shards, one by default
+		 **/
+		std::vector<std::unique_ptr<Shard>> m_shards;
+
+		/**
+		 * Shard of the next agent added
+		 **/
+		std::atomic<size_t> m_next_shard;
+
+		/**
+		 * True if the agents created by an agent join the shard of their creator
+		 **/
+		bool m_is_using_creator_shard;
+
+		/**
+		 * Shards are balanced again when the largest and smallest differ by more than 1 / s_shard_imbalance
+		 * of the mean size
+		 **/
+		static constexpr size_t s_shard_imbalance = 4;
+
+		/**
+		 * Alive agents: positions in m_agents, in no particular order (swap-remove when stopped)
+		 **/
+		mutable std::vector<std::uint32_t> m_alive_agents;
+
+		/**
+		 * Position in m_alive_agents of each agent of m_agents, s_not_alive if stopped
+		 **/
+		mutable std::vector<std::uint32_t> m_alive_positions;
+
+		/**
+		 * Protect the alive agents, agents may be stopped and sampled during the turn
+		 **/
+		mutable std::mutex m_alive_mutex;
+
+		/**
+		 * True if agents were stopped since the last process_buffers (protected by m_alive_mutex):
+		 * agents only die by stop, otherwise dead agents are not searched
+		 **/
+		bool m_has_stopped_agents;
+
+		/**
+		 * Number of agents using observables, without them and typed observables no snapshot is needed
 		 **/
-		tsl::ordered_map<std::string, AgentPointer> m_agents;
+		size_t m_observing_agent_count;
 
 		/**
-		 * Agents: name, id
+		 * Position of a stopped agent
 		 **/
-		std::unordered_multimap<std::string, std::string> m_agents_by_name;
+		static constexpr std::uint32_t s_not_alive = std::numeric_limits<std::uint32_t>::max();
 
 		/**
-		 * New agent buffer
-		 */
-		MPSCQueue<AgentPointer> m_new_agents;
+		 * Single shard: number of agents scanned by one parallel task in process_buffers
+		 **/
+		size_t m_chunk_size;
 
 		/**
-		 * Thread pool for agents
+		 * Single shard: dead agents found in each chunk (reused across turns)
 		 **/
-		ThreadPool m_pool;
+		std::vector<std::vector<Agent*>> m_chunk_dead_agents;
+
+		/**
+		 * Reactive mode: agents to run on the next turn, pushed by the agents themselves when they
+		 * receive a message or wake up (see Agent::schedule)
+		 **/
+		MPSCQueue<AgentHandle> m_ready_agents;
+
+		/**
+		 * Reactive mode: agents run by the current turn (reused across turns)
+		 **/
+		std::vector<AgentHandle> m_scheduled_agents;
+
+		/**
+		 * Asynchronous mode: workers, one per thread of the pool
+		 **/
+		std::vector<std::unique_ptr<AsyncWorker>> m_async_workers;
+
+		/**
+		 * Asynchronous mode: worker of the next agent scheduled from outside the workers
+		 **/
+		std::atomic<size_t> m_next_async_worker;
+
+		/**
+		 * Asynchronous mode: agents scheduled and not run yet, 0 when every agent is idle
+		 **/
+		std::atomic<size_t> m_async_scheduled_count;
+
+		/**
+		 * Asynchronous mode: agent runs of the current turn
+		 **/
+		std::atomic<size_t> m_async_run_count;
+
+		/**
+		 * Asynchronous mode: number of idle workers waiting on m_async_wake_count
+		 **/
+		std::atomic<size_t> m_async_parked_count;
+
+		/**
+		 * Asynchronous mode: incremented to wake up the idle workers
+		 **/
+		std::atomic<std::uint32_t> m_async_wake_count;
+
+		/**
+		 * Reactive and Asynchronous modes: true if observables or agents changed since the last snapshot
+		 **/
+		std::atomic<bool> m_is_snapshot_outdated;
+
+		/**
+		 * Slots: handle slot, position in m_agents
+		 **/
+		std::vector<AgentSlot> m_slots;
+
+		/**
+		 * Released slots
+		 **/
+		std::vector<std::uint32_t> m_free_slots;
+
+		/**
+		 * Agents: id, handle (only used at API boundaries)
+		 **/
+		std::unordered_map<AgentId, AgentHandle> m_handles;
+
+		/**
+		 * Agents by name and by fragment of name
+		 **/
+		NameIndex m_names;
+
+		/**
+		 * Typed observables of the agents, by slot
+		 **/
+		ObservableColumns m_observable_columns;
+
+		/**
+		 * Work-stealing pool for agents
+		 **/
+		WorkStealingPool m_pool;
 
 		/**
 		 * Environment mode.
@@ -62,10 +265,35 @@ namespace cam {
 		EnvironmentMasMode m_environment_mas_mode;
 
 		/**
-		 * Random generator
+		 * Seed of the random streams
 		 **/
 		unsigned int m_seed;
 
+		/**
+		 * Random stream of the environment (stream 0), agents get the next streams
+		 **/
+		mutable RandomStream m_random;
+
+		/**
+		 * Number of random streams given to the agents added outside of the agents
+		 **/
+		std::atomic<std::uint64_t> m_stream_count;
+
+		/**
+		 * Number of agents per parallel task (0 = adaptive)
+		 **/
+		size_t m_grain_size;
+
+		/**
+		 * Mean run time of one agent (in nanoseconds) measured during the previous parallel turn
+		 **/
+		double m_agent_run_time;
+
+		/**
+		 * Run order of the agents in SequentialRandom mode, reused across turns
+		 **/
+		std::vector<std::uint32_t> m_agent_order;
+
 	public:
 		/**
 		 * Initializes a new instance of a collection of agents
@@ -90,11 +318,24 @@ namespace cam {
 		void add(const AgentPointer& p_agent);
 
 		/**
-		 * Returns a randomly selected agent from the environment
-		 * @return Random agent
+		 * Returns a randomly selected alive agent from the environment, in constant time
+		 * @return Random agent, nullptr if every agent is stopped
 		 **/
 		[[nodiscard]] const AgentPointer& random_agent() const;
 
+		/**
+		 * Returns randomly selected alive agents, without replacement
+		 * @param p_count Number of agents
+		 * @return Random agents, fewer if there are not enough alive agents
+		 **/
+		[[nodiscard]] std::vector<AgentPointer> random_agents(size_t p_count) const;
+
+		/**
+		 * Remove a stopped agent from the alive agents
+		 * @param p_handle The agent handle
+		 **/
+		void set_stopped(const AgentHandle& p_handle);
+
 		/**
 		 * Return true if the agent exists
 		 * @return True if exists
@@ -106,20 +347,86 @@ namespace cam {
 		 * @param p_id The agent id
 		 * @return True if exists
 		 **/
-		[[nodiscard]] bool contains(const std::string& p_id) const;
+		[[nodiscard]] bool contains(const AgentId& p_id) const;
+
+		/**
+		 * Return true if the handle still designates an agent
+		 * @param p_handle The agent handle
+		 * @return True if exists
+		 **/
+		[[nodiscard]] bool contains(const AgentHandle& p_handle) const {
+			return p_handle.m_slot < m_slots.size() && m_slots[p_handle.m_slot].m_generation == p_handle.m_generation;
+		}
 
 		/**
-		 * Remove agent
+		 * True if in Reactive or Asynchronous mode
+		 * @return True if only the scheduled agents are run
+		 **/
+		[[nodiscard]] bool is_reactive() const;
+
+		/**
+		 * Run an agent on the next turn (Reactive mode) or as soon as possible (Asynchronous mode)
+		 * @param p_handle The agent handle, ignored if no longer valid when the agent is run
+		 **/
+		void schedule(const AgentHandle& p_handle);
+
+		/**
+		 * True if agents are scheduled (Reactive and Asynchronous modes)
+		 * @return True if agents are scheduled
+		 **/
+		[[nodiscard]] bool has_scheduled_agents() const {
+			return !m_ready_agents.empty() || m_async_scheduled_count.load(std::memory_order_acquire) != 0;
+		}
+
+		/**
+		 * The observables snapshot must be updated before the next turn (Reactive and Asynchronous modes)
+		 **/
+		void set_snapshot_outdated() {
+			if (!m_is_snapshot_outdated.load(std::memory_order_relaxed)) {
+				m_is_snapshot_outdated.store(true, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * Remove agent, the agent is stopped now and removed when processing buffers
 		 * @param p_id The agent id
 		 **/
-		void remove(const std::string& p_id);
+		void remove(const AgentId& p_id);
 
 		/**
 		 * Get agent by id
 		 * @param p_id The agent id
 		 * @return The agent
 		 **/
-		AgentPointer get(const std::string& p_id) const;
+		AgentPointer get(const AgentId& p_id) const;
+
+		/**
+		 * Get agent by handle
+		 * @param p_handle The agent handle
+		 * @return The agent, nullptr if the handle is no longer valid
+		 **/
+		AgentPointer get(const AgentHandle& p_handle) const;
+
+		/**
+		 * Get agents by name
+		 * @param p_name The agent name
+		 * @return The agents ids, in insertion order
+		 **/
+		[[nodiscard]] std::span<const AgentId> get_by_name(const std::string& p_name) const;
+
+		/**
+		 * Get agents handles by name, without hashing each receiver again
+		 * @param p_name The agent name
+		 * @return The agents handles, in insertion order
+		 **/
+		[[nodiscard]] std::span<const AgentHandle> get_handles_by_name(const std::string& p_name) const;
+
+		/**
+		 * Get agents whose name contains a fragment
+		 * @param p_fragment_name The fragment name
+		 * @return The agents ids, in insertion order
+		 **/
+		[[nodiscard]] std::vector<AgentId> get_by_fragment_name(const std::string& p_fragment_name) const;
 
 		/**
 		 * Run one turn
@@ -131,19 +438,49 @@ namespace cam {
 		 **/
 		void process_buffers();
 
+		/**
+		 * Set the number of agents run sequentially by one parallel task
+		 * @param p_grain_size Number of agents per task, 0 to adapt it to the previous turn
+		 **/
+		void set_grain_size(const size_t p_grain_size) { m_grain_size = p_grain_size; }
+
+		/**
+		 * Set the number of shards. Call it before starting the simulation: the agents already
+		 * added are split between the shards.
+		 * @param p_shard_count Number of shards, at least one
+		 **/
+		void set_shard_count(size_t p_shard_count);
+
+		/**
+		 * Add the agents created by an agent to the shard of their creator instead of spreading them
+		 * @param p_enabled True to enable
+		 **/
+		void set_creator_shard(const bool p_enabled) { m_is_using_creator_shard = p_enabled; }
+
+		/**
+		 * Return the number of shards
+		 * @return Number of shards
+		 **/
+		[[nodiscard]] size_t get_shard_count() const { return m_shards.size(); }
+
+		/**
+		 * Return the number of agents per parallel task for this turn
+		 * @param p_count Number of agents to run
+		 * @return Number of agents per task
+		 **/
+		[[nodiscard]] size_t get_grain_size(size_t p_count) const;
+
 		/**
 		 * Get all ids
 		 * @param p_alive_only if true then return only alive agents
 		 * @return All ids
 		 **/
-		[[nodiscard]] std::vector<std::string> get_ids(bool p_alive_only = true);
+		[[nodiscard]] std::vector<AgentId> get_ids(bool p_alive_only = true);
 
 		/**
-		 * Return a vector (p_number length) of random index.
-		 * Fisher-Yates shuffle.
-		 * @param p_number Number of value in the returned vector
+		 * Shuffle m_agent_order in place (Fisher-Yates), it is reset when the number of agents changes
 		 **/
-		std::vector<int> random_permutation(size_t p_number) const;
+		void shuffle_agent_order();
 
 		/**
 		 * Return random number
@@ -157,5 +494,80 @@ namespace cam {
 		AgentCollection(const AgentCollection&) = delete;
 
 		AgentCollection& operator=(AgentCollection&) = delete;
+
+	private:
+
+		/**
+		 * Single shard: find the dead agents, chunks of agents are scanned in parallel
+		 **/
+		void collect_dead_agents();
+
+		/**
+		 * Single shard: move the alive agents to m_next_agents, chunks of agents are moved in parallel
+		 * @return Number of alive agents
+		 **/
+		size_t move_alive_agents();
+
+		/**
+		 * Move the alive agents of [p_begin, p_end) to m_next_agents
+		 * @param p_begin First agent
+		 * @param p_end Last agent (excluded)
+		 * @param p_next_index Position of the first alive agent in m_next_agents
+		 * @return Position after the last alive agent
+		 **/
+		size_t move_alive_agents(size_t p_begin, size_t p_end, size_t p_next_index);
+
+		/**
+		 * Rebuild the alive agents from m_agents
+		 **/
+		void update_alive_agents();
+
+		/**
+		 * Split m_agents evenly between the shards if their sizes diverge. Shards are contiguous:
+		 * only their bounds change, no agent is moved.
+		 * @param p_is_forced True to split even if the sizes are close
+		 **/
+		void balance_shards(bool p_is_forced = false);
+
+		/**
+		 * Queue a new agent in a shard, its random stream is kept
+		 * @param p_agent Agent to add
+		 **/
+		void place(const AgentPointer& p_agent);
+
+		/**
+		 * Run a scheduled agent (Reactive and Asynchronous modes)
+		 * @param p_handle The agent handle, ignored if no longer valid
+		 **/
+		void run_scheduled_agent(const AgentHandle& p_handle);
+
+		/**
+		 * Asynchronous mode: run the ready agents of a worker until every agent is idle or the turn is over
+		 * @param p_worker The worker
+		 * @param p_turn_length Number of agent runs of the turn
+		 **/
+		void run_async_worker(size_t p_worker, size_t p_turn_length);
+
+		/**
+		 * Asynchronous mode: take the next agents to run, from the worker or stolen from another one
+		 * @param p_worker The worker, its m_agents is filled
+		 * @return False if no agent is ready
+		 **/
+		bool take_async_agents(size_t p_worker);
+
+		/**
+		 * Asynchronous mode: wake up the idle workers, if any
+		 **/
+		void wake_async_workers();
+
+		/**
+		 * Move an agent to m_next_agents
+		 * @param p_agent The agent
+		 * @param p_next_index Its position in m_next_agents
+		 **/
+		void move_agent(AgentPointer& p_agent, const size_t p_next_index) {
+			m_slots[p_agent->m_handle.m_slot].m_dense_index = static_cast<std::uint32_t>(p_next_index);
+			m_next_agents[p_next_index] = std::move(p_agent);
+		}
 	};
 } // namespace cam
@@ -0,0 +1,59 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Compact handle of an agent inside its collection. The slot never moves while the agent
+	 * is alive, the generation is incremented when the slot is released so that an old handle
+	 * cannot reach the next agent stored in the same slot.
+	 **/
+	struct AgentHandle {
+		/**
+		 * Invalid slot.
+		 **/
+		static constexpr std::uint32_t s_invalid_slot = std::numeric_limits<std::uint32_t>::max();
+
+		/**
+		 * Slot index.
+		 **/
+		std::uint32_t m_slot = s_invalid_slot;
+
+		/**
+		 * Slot generation.
+		 **/
+		std::uint32_t m_generation = 0;
+
+		/**
+		 * True if the handle has been given by a collection.
+		 * @return True if valid
+		 **/
+		[[nodiscard]] bool is_valid() const { return m_slot != s_invalid_slot; }
+
+		bool operator==(const AgentHandle&) const = default;
+	};
+
+} // namespace cam
@@ -0,0 +1,120 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "AgentId.h"
+
+#include <random>
+
+namespace {
+	/**
+	 * SplitMix64 step
+	 * @param p_state generator state
+	 * @return next random value
+	 */
+	std::uint64_t split_mix(std::uint64_t& p_state) {
+		std::uint64_t l_value = (p_state += 0x9E3779B97F4A7C15ULL);
+		l_value = (l_value ^ (l_value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		l_value = (l_value ^ (l_value >> 27)) * 0x94D049BB133111EBULL;
+		return l_value ^ (l_value >> 31);
+	}
+
+	/**
+	 * Hexadecimal value of a character
+	 * @param p_char the character
+	 * @return the value, -1 if not hexadecimal
+	 */
+	int hex_value(const char p_char) {
+		if (p_char >= '0' && p_char <= '9') {
+			return p_char - '0';
+		}
+		if (p_char >= 'a' && p_char <= 'f') {
+			return p_char - 'a' + 10;
+		}
+		if (p_char >= 'A' && p_char <= 'F') {
+			return p_char - 'A' + 10;
+		}
+		return -1;
+	}
+}
+
+cam::AgentId cam::AgentId::generate() {
+	// Seeded once per thread
+	thread_local std::uint64_t t_state = [] {
+		std::random_device l_device;
+		return (static_cast<std::uint64_t>(l_device()) << 32) ^ l_device();
+	}();
+
+	std::uint64_t l_high = split_mix(t_state);
+	std::uint64_t l_low = split_mix(t_state);
+
+	// Version 4, variant 1
+	l_high = (l_high & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
+	l_low = (l_low & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+	return {l_high, l_low};
+}
+
+std::optional<cam::AgentId> cam::AgentId::parse(const std::string_view p_string) {
+	if (p_string.size() != 36) {
+		return {};
+	}
+
+	std::uint64_t l_halves[2] = {0, 0};
+	size_t l_digit = 0;
+	for (size_t l_index = 0; l_index < p_string.size(); l_index++) {
+		if (l_index == 8 || l_index == 13 || l_index == 18 || l_index == 23) {
+			if (p_string[l_index] != '-') {
+				return {};
+			}
+			continue;
+		}
+		const int l_value = hex_value(p_string[l_index]);
+		if (l_value < 0) {
+			return {};
+		}
+		std::uint64_t& l_half = l_halves[l_digit++ / 16];
+		l_half = (l_half << 4) | static_cast<std::uint64_t>(l_value);
+	}
+	return AgentId(l_halves[0], l_halves[1]);
+}
+
+std::string cam::AgentId::to_string() const {
+	static constexpr char s_digits[] = "0123456789abcdef";
+
+	std::string l_result(36, '-');
+	size_t l_position = 0;
+	for (size_t l_digit = 0; l_digit < 32; l_digit++) {
+		if (l_position == 8 || l_position == 13 || l_position == 18 || l_position == 23) {
+			l_position++;
+		}
+		const std::uint64_t l_half = l_digit < 16 ? m_high : m_low;
+		l_result[l_position++] = s_digits[(l_half >> (60 - 4 * (l_digit % 16))) & 0xF];
+	}
+	return l_result;
+}
+
+std::ostream& cam::operator<<(std::ostream& p_stream, const AgentId& p_id) {
+	return p_stream << p_id.to_string();
+}
+
+void cam::to_json(json& p_json, const AgentId& p_id) {
+	p_json = p_id.to_string();
+}
+
+void cam::from_json(const json& p_json, AgentId& p_id) {
+	p_id = AgentId::parse(p_json.get<std::string>()).value_or(AgentId());
+}
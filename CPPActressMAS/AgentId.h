@@ -0,0 +1,143 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Unique agent identifier: a random 128 bits value (UUID version 4 layout).
+	 * Trivially copyable, the string form is only built when asked.
+	 **/
+	class AgentId final {
+
+	protected:
+		/**
+		 * Most significant bits.
+		 **/
+		std::uint64_t m_high;
+
+		/**
+		 * Least significant bits.
+		 **/
+		std::uint64_t m_low;
+
+	public:
+		/**
+		 * Nil id.
+		 **/
+		constexpr AgentId() :
+				m_high(0),
+				m_low(0) {}
+
+		/**
+		 * Id from its two halves.
+		 * @param p_high Most significant bits
+		 * @param p_low Least significant bits
+		 **/
+		constexpr AgentId(const std::uint64_t p_high, const std::uint64_t p_low) :
+				m_high(p_high),
+				m_low(p_low) {}
+
+		/**
+		 * Generate a new random id, from a generator local to the calling thread.
+		 * @return New id
+		 **/
+		static AgentId generate();
+
+		/**
+		 * Parse an id formatted as xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx.
+		 * @param p_string The string id
+		 * @return The id, nothing if the string is malformed
+		 **/
+		static std::optional<AgentId> parse(std::string_view p_string);
+
+		/**
+		 * Format id.
+		 * @return The string id xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+		 **/
+		[[nodiscard]] std::string to_string() const;
+
+		/**
+		 * True if nil.
+		 * @return True if nil
+		 **/
+		[[nodiscard]] constexpr bool is_nil() const { return m_high == 0 && m_low == 0; }
+
+		/**
+		 * Get most significant bits.
+		 * @return Most significant bits
+		 **/
+		[[nodiscard]] constexpr std::uint64_t get_high() const { return m_high; }
+
+		/**
+		 * Get least significant bits.
+		 * @return Least significant bits
+		 **/
+		[[nodiscard]] constexpr std::uint64_t get_low() const { return m_low; }
+
+		constexpr auto operator<=>(const AgentId&) const = default;
+
+		/**
+		 * Serialize id
+		 * @param p_archive archive
+		 */
+		template<class Archive>
+		void serialize(Archive& p_archive) {
+			p_archive(m_high, m_low);
+		}
+	};
+
+	/**
+	 * Print id.
+	 **/
+	std::ostream& operator<<(std::ostream& p_stream, const AgentId& p_id);
+
+	/**
+	 * From/to json (string form).
+	 **/
+	void to_json(json& p_json, const AgentId& p_id);
+
+	void from_json(const json& p_json, AgentId& p_id);
+
+} // namespace cam
+
+/**
+ * Hash of an agent id
+ */
+template<>
+struct std::hash<cam::AgentId> {
+	size_t operator()(const cam::AgentId& p_id) const noexcept {
+		return static_cast<size_t>(p_id.get_low() ^ (p_id.get_high() * 0x9E3779B97F4A7C15ULL));
+	}
+};
@@ -0,0 +1,133 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "ColumnQuery.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+	/**
+	 * Match a block of at most 64 values against [p_min, p_max], NaN never matches
+	 * @param p_values The values
+	 * @param p_count Number of values
+	 * @param p_min The min value
+	 * @param p_max The max value
+	 * @return Bit i set if value i matches
+	 */
+	std::uint64_t match_range(const double* p_values, const size_t p_count, const double p_min, const double p_max) {
+		std::uint64_t l_bits = 0;
+		size_t l_index = 0;
+#if defined(__AVX2__)
+		const __m256d l_min = _mm256_set1_pd(p_min);
+		const __m256d l_max = _mm256_set1_pd(p_max);
+		for (; l_index + 4 <= p_count; l_index += 4) {
+			const __m256d l_value = _mm256_loadu_pd(p_values + l_index);
+			const __m256d l_match = _mm256_and_pd(_mm256_cmp_pd(l_value, l_min, _CMP_GE_OQ),
+												  _mm256_cmp_pd(l_value, l_max, _CMP_LE_OQ));
+			l_bits |= static_cast<std::uint64_t>(_mm256_movemask_pd(l_match)) << l_index;
+		}
+#endif
+		for (; l_index < p_count; l_index++) {
+			const double l_value = p_values[l_index];
+			l_bits |= static_cast<std::uint64_t>(l_value >= p_min && l_value <= p_max) << l_index;
+		}
+		return l_bits;
+	}
+
+	/**
+	 * Match a block of at most 64 positions against a circle, NaN never matches
+	 * @param p_xs The X values
+	 * @param p_ys The Y values
+	 * @param p_count Number of values
+	 * @param p_x Center X
+	 * @param p_y Center Y
+	 * @param p_squared_radius Squared radius
+	 * @return Bit i set if position i matches
+	 */
+	std::uint64_t match_distance(const double* p_xs, const double* p_ys, const size_t p_count, const double p_x,
+								 const double p_y, const double p_squared_radius) {
+		std::uint64_t l_bits = 0;
+		size_t l_index = 0;
+#if defined(__AVX2__)
+		const __m256d l_x = _mm256_set1_pd(p_x);
+		const __m256d l_y = _mm256_set1_pd(p_y);
+		const __m256d l_squared_radius = _mm256_set1_pd(p_squared_radius);
+		for (; l_index + 4 <= p_count; l_index += 4) {
+			const __m256d l_dx = _mm256_sub_pd(_mm256_loadu_pd(p_xs + l_index), l_x);
+			const __m256d l_dy = _mm256_sub_pd(_mm256_loadu_pd(p_ys + l_index), l_y);
+			const __m256d l_distance = _mm256_add_pd(_mm256_mul_pd(l_dx, l_dx), _mm256_mul_pd(l_dy, l_dy));
+			const __m256d l_match = _mm256_cmp_pd(l_distance, l_squared_radius, _CMP_LE_OQ);
+			l_bits |= static_cast<std::uint64_t>(_mm256_movemask_pd(l_match)) << l_index;
+		}
+#endif
+		for (; l_index < p_count; l_index++) {
+			const double l_dx = p_xs[l_index] - p_x;
+			const double l_dy = p_ys[l_index] - p_y;
+			l_bits |= static_cast<std::uint64_t>(l_dx * l_dx + l_dy * l_dy <= p_squared_radius) << l_index;
+		}
+		return l_bits;
+	}
+}
+
+cam::ColumnQuery& cam::ColumnQuery::where_in_range(const ObservableKey p_key, const double p_min, const double p_max) {
+	m_ranges.push_back({p_key, p_min, p_max});
+	return *this;
+}
+
+cam::ColumnQuery& cam::ColumnQuery::where_within(const ObservableKey p_x_key, const ObservableKey p_y_key,
+												 const double p_x, const double p_y, const double p_radius) {
+	m_distances.push_back({p_x_key, p_y_key, p_x, p_y, p_radius});
+	return *this;
+}
+
+void cam::ColumnQuery::evaluate(const ObservableColumns& p_columns, std::vector<std::uint64_t>& p_mask) const {
+	const size_t l_count = p_columns.get_slot_count();
+	p_mask.assign((l_count + 63) / 64, ~std::uint64_t(0));
+	if (l_count % 64 != 0) {
+		p_mask.back() = (std::uint64_t(1) << (l_count % 64)) - 1;
+	}
+
+	// One pass per predicate, blocks already rejected are skipped
+	for (const RangePredicate& l_range: m_ranges) {
+		const double* l_values = p_columns.get_published_column(l_range.m_key).data();
+		for (size_t l_word = 0; l_word < p_mask.size(); l_word++) {
+			if (p_mask[l_word] != 0) {
+				const size_t l_first = l_word * 64;
+				p_mask[l_word] &= match_range(l_values + l_first, std::min<size_t>(64, l_count - l_first),
+											  l_range.m_min, l_range.m_max);
+			}
+		}
+	}
+	for (const DistancePredicate& l_distance: m_distances) {
+		const double* l_xs = p_columns.get_published_column(l_distance.m_x_key).data();
+		const double* l_ys = p_columns.get_published_column(l_distance.m_y_key).data();
+		const double l_squared_radius = l_distance.m_radius * l_distance.m_radius;
+		for (size_t l_word = 0; l_word < p_mask.size(); l_word++) {
+			if (p_mask[l_word] != 0) {
+				const size_t l_first = l_word * 64;
+				p_mask[l_word] &= match_distance(l_xs + l_first, l_ys + l_first,
+												 std::min<size_t>(64, l_count - l_first), l_distance.m_x,
+												 l_distance.m_y, l_squared_radius);
+			}
+		}
+	}
+}
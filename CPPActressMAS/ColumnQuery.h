@@ -0,0 +1,136 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ObservableColumns.h"
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Perception over typed observables: a conjunction of numeric predicates evaluated on the
+	 * published columns of the whole population at once. Each predicate is a branchless scan of
+	 * one or two columns (AVX2 when available, scalar otherwise) producing a bit per agent slot.
+	 **/
+	class ColumnQuery final {
+	public:
+		/**
+		 * m_min <= value <= m_max
+		 **/
+		struct RangePredicate {
+			ObservableKey m_key;
+			double m_min;
+			double m_max;
+		};
+
+		/**
+		 * Distance from (m_x, m_y) to the position (x, y) <= m_radius
+		 **/
+		struct DistancePredicate {
+			ObservableKey m_x_key;
+			ObservableKey m_y_key;
+			double m_x;
+			double m_y;
+			double m_radius;
+		};
+
+	protected:
+		/**
+		 * Range predicates, all must match
+		 **/
+		std::vector<RangePredicate> m_ranges;
+
+		/**
+		 * Distance predicates, all must match
+		 **/
+		std::vector<DistancePredicate> m_distances;
+
+	public:
+		/**
+		 * Observed agents must have p_key in [p_min, p_max]
+		 * @param p_key The observable key
+		 * @param p_min The min value
+		 * @param p_max The max value
+		 * @return this query
+		 **/
+		ColumnQuery& where_in_range(ObservableKey p_key, double p_min, double p_max);
+
+		/**
+		 * Observed agents must have p_key >= p_min
+		 * @param p_key The observable key
+		 * @param p_min The min value
+		 * @return this query
+		 **/
+		ColumnQuery& where_at_least(const ObservableKey p_key, const double p_min) {
+			return where_in_range(p_key, p_min, std::numeric_limits<double>::infinity());
+		}
+
+		/**
+		 * Observed agents must have p_key <= p_max
+		 * @param p_key The observable key
+		 * @param p_max The max value
+		 * @return this query
+		 **/
+		ColumnQuery& where_at_most(const ObservableKey p_key, const double p_max) {
+			return where_in_range(p_key, -std::numeric_limits<double>::infinity(), p_max);
+		}
+
+		/**
+		 * Observed agents must be at distance p_radius or less from (p_x, p_y)
+		 * @param p_x_key The observable key of the X position
+		 * @param p_y_key The observable key of the Y position
+		 * @param p_x X
+		 * @param p_y Y
+		 * @param p_radius Radius
+		 * @return this query
+		 **/
+		ColumnQuery& where_within(ObservableKey p_x_key, ObservableKey p_y_key, double p_x, double p_y,
+								  double p_radius);
+
+		/**
+		 * Remove all predicates
+		 * @return this query
+		 **/
+		ColumnQuery& clear() {
+			m_ranges.clear();
+			m_distances.clear();
+			return *this;
+		}
+
+		/**
+		 * True if there is no predicate (every agent matches)
+		 * @return True if empty
+		 **/
+		[[nodiscard]] bool empty() const { return m_ranges.empty() && m_distances.empty(); }
+
+		/**
+		 * Evaluate the query on the published values
+		 * @param p_columns The typed observables
+		 * @param p_mask Output, bit (slot % 64) of word (slot / 64) is set if the slot matches
+		 **/
+		void evaluate(const ObservableColumns& p_columns, std::vector<std::uint64_t>& p_mask) const;
+	};
+
+} // namespace cam
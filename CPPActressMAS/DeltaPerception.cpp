@@ -0,0 +1,98 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "DeltaPerception.h"
+
+void cam::DeltaPerception::begin() {
+	m_stamp++;
+	m_perceived_count = 0;
+	m_added.clear();
+	m_changed.clear();
+	m_removed.clear();
+}
+
+bool cam::DeltaPerception::update_input(const std::uint64_t p_version, const double p_radius,
+										const PerceptionQuery& p_query) {
+	if (m_is_input_valid && m_version == p_version && m_radius == p_radius && m_query == p_query) {
+		return false;
+	}
+	m_is_input_valid = true;
+	m_version = p_version;
+	m_radius = p_radius;
+	if (m_query != p_query) {
+		m_query = p_query;
+	}
+	return true;
+}
+
+void cam::DeltaPerception::perceive(const AgentHandle& p_handle, const AgentId& p_id, const std::uint64_t p_version,
+									const ObservablesPointer& p_observables) {
+	m_perceived_count++;
+	if (p_handle.m_slot >= m_perceived_indexes.size()) {
+		m_perceived_indexes.resize(p_handle.m_slot + 1, s_not_perceived);
+	}
+	if (const std::uint32_t l_index = m_perceived_indexes[p_handle.m_slot]; l_index != s_not_perceived) {
+		Entry& l_entry = m_perceived[l_index];
+		if (l_entry.m_handle == p_handle) {
+			l_entry.m_stamp = m_stamp;
+			if (l_entry.m_version != p_version) {
+				l_entry.m_version = p_version;
+				l_entry.m_observables = p_observables;
+				m_changed.push_back({p_id, p_observables});
+			}
+			return;
+		}
+
+		// The slot has been reused by another agent
+		remove(l_index);
+	}
+	m_perceived_indexes[p_handle.m_slot] = static_cast<std::uint32_t>(m_perceived.size());
+	m_perceived.push_back({p_id, p_handle, p_version, m_stamp, p_observables});
+	m_added.push_back({p_id, p_observables});
+}
+
+void cam::DeltaPerception::forget(const std::uint32_t p_slot) {
+	if (p_slot < m_perceived_indexes.size() && m_perceived_indexes[p_slot] != s_not_perceived) {
+		remove(m_perceived_indexes[p_slot]);
+	}
+}
+
+void cam::DeltaPerception::forget_unperceived() {
+	// Every known agent has been perceived again
+	if (m_perceived_count == m_perceived.size()) {
+		return;
+	}
+	for (std::uint32_t l_index = 0; l_index < m_perceived.size();) {
+		if (m_perceived[l_index].m_stamp != m_stamp) {
+			remove(l_index);
+		} else {
+			l_index++;
+		}
+	}
+}
+
+void cam::DeltaPerception::remove(const std::uint32_t p_index) {
+	Entry& l_entry = m_perceived[p_index];
+	m_removed.push_back({l_entry.m_id, std::move(l_entry.m_observables)});
+	m_perceived_indexes[l_entry.m_handle.m_slot] = s_not_perceived;
+	if (p_index + 1 != m_perceived.size()) {
+		l_entry = std::move(m_perceived.back());
+		m_perceived_indexes[l_entry.m_handle.m_slot] = p_index;
+	}
+	m_perceived.pop_back();
+}
@@ -0,0 +1,208 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "AgentHandle.h"
+#include "AgentId.h"
+#include "Observables.h"
+#include "PerceptionQuery.h"
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * An agent perceived by another one
+	 **/
+	struct PerceivedAgent {
+		/**
+		 * Id of the perceived agent.
+		 **/
+		AgentId m_id;
+
+		/**
+		 * Its observables (the last perceived ones if removed).
+		 **/
+		ObservablesPointer m_observables;
+	};
+
+	/**
+	 * Perception of an agent from one turn to the next: the agents perceived for the first time,
+	 * the agents whose observables changed and the agents no longer perceived.
+	 **/
+	class DeltaPerception final {
+		/**
+		 * Last perception of an agent
+		 **/
+		struct Entry {
+			AgentId m_id;
+			AgentHandle m_handle;
+			std::uint64_t m_version;
+			std::uint64_t m_stamp;
+			ObservablesPointer m_observables;
+		};
+
+		/**
+		 * Not perceived slot
+		 **/
+		static constexpr std::uint32_t s_not_perceived = std::numeric_limits<std::uint32_t>::max();
+
+	protected:
+		/**
+		 * Perceived agents
+		 **/
+		std::vector<Entry> m_perceived;
+
+		/**
+		 * Index in m_perceived of each agent slot, s_not_perceived if not perceived
+		 **/
+		std::vector<std::uint32_t> m_perceived_indexes;
+
+		/**
+		 * Current perception stamp
+		 **/
+		std::uint64_t m_stamp;
+
+		/**
+		 * Number of agents perceived since begin
+		 **/
+		size_t m_perceived_count;
+
+		/**
+		 * Snapshot version of the last perception, 0 if none
+		 **/
+		std::uint64_t m_snapshot;
+
+		/**
+		 * Input of the last perception: observables version, radius and query of the perceiving agent
+		 **/
+		bool m_is_input_valid;
+		std::uint64_t m_version;
+		double m_radius;
+		PerceptionQuery m_query;
+
+		/**
+		 * Differences found by the current perception (reused across turns)
+		 **/
+		std::vector<PerceivedAgent> m_added;
+		std::vector<PerceivedAgent> m_changed;
+		std::vector<PerceivedAgent> m_removed;
+
+		/**
+		 * Remove a perceived agent
+		 * @param p_index Index in m_perceived
+		 **/
+		void remove(std::uint32_t p_index);
+
+	public:
+		/**
+		 * Nothing perceived
+		 **/
+		DeltaPerception() :
+				m_stamp(0),
+				m_perceived_count(0),
+				m_snapshot(0),
+				m_is_input_valid(false),
+				m_version(0),
+				m_radius(0) {}
+
+		/**
+		 * Start a perception
+		 **/
+		void begin();
+
+		/**
+		 * Set the perception of the perceiving agent
+		 * @param p_version Version of its observables
+		 * @param p_radius Its perception radius
+		 * @param p_query Its perception query
+		 * @return True if changed since the last perception (everything must be perceived again)
+		 **/
+		bool update_input(std::uint64_t p_version, double p_radius, const PerceptionQuery& p_query);
+
+		/**
+		 * Perceive everything again at the next perception (the perception filter changed)
+		 **/
+		void invalidate() { m_is_input_valid = false; }
+
+		/**
+		 * Get the snapshot version of the last perception
+		 * @return The version, 0 if none
+		 **/
+		[[nodiscard]] std::uint64_t get_snapshot() const { return m_snapshot; }
+
+		/**
+		 * Set the snapshot version of the perception
+		 * @param p_snapshot The version
+		 **/
+		void set_snapshot(const std::uint64_t p_snapshot) { m_snapshot = p_snapshot; }
+
+		/**
+		 * Perceive an agent
+		 * @param p_handle Handle of the agent
+		 * @param p_id Id of the agent
+		 * @param p_version Version of its observables
+		 * @param p_observables Its observables
+		 **/
+		void perceive(const AgentHandle& p_handle, const AgentId& p_id, std::uint64_t p_version,
+					  const ObservablesPointer& p_observables);
+
+		/**
+		 * No longer perceive the agent of a slot, if perceived
+		 * @param p_slot Slot of the agent
+		 **/
+		void forget(std::uint32_t p_slot);
+
+		/**
+		 * End a full perception: the agents not perceived since begin are removed
+		 **/
+		void forget_unperceived();
+
+		/**
+		 * True if nothing changed
+		 * @return True if no agent added, changed or removed
+		 **/
+		[[nodiscard]] bool empty() const { return m_added.empty() && m_changed.empty() && m_removed.empty(); }
+
+		/**
+		 * Get the agents perceived for the first time
+		 * @return The agents
+		 **/
+		[[nodiscard]] std::span<const PerceivedAgent> get_added() const { return m_added; }
+
+		/**
+		 * Get the agents whose observables changed
+		 * @return The agents
+		 **/
+		[[nodiscard]] std::span<const PerceivedAgent> get_changed() const { return m_changed; }
+
+		/**
+		 * Get the agents no longer perceived
+		 * @return The agents
+		 **/
+		[[nodiscard]] std::span<const PerceivedAgent> get_removed() const { return m_removed; }
+	};
+
+} // namespace cam
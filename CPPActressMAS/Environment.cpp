@@ -18,6 +18,9 @@
 
 #include "Environment.h"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <thread>
 
 #include "Agent.h"
@@ -28,7 +31,11 @@ cam::Environment::Environment(const int p_no_turns, const EnvironmentMasMode& p_
 		m_no_turns(p_no_turns),
 		m_delay_after_turn(p_delay_after_turn),
 		m_agent_collection(p_mode, p_seed),
-		m_remote_client(nullptr) {
+		m_remote_client(nullptr),
+		m_snapshot_version(0),
+		m_observed_changes_start(0),
+		m_position_x_key("x"),
+		m_position_y_key("y") {
 }
 
 cam::Environment::~Environment() {
@@ -40,12 +47,12 @@ cam::Environment::~Environment() {
 	}
 }
 
-const std::string& cam::Environment::add(AgentPointer&& p_agent) {
+const cam::AgentId& cam::Environment::add(AgentPointer&& p_agent) {
 	m_agent_collection.add(p_agent);
 	return p_agent->get_id();
 }
 
-cam::AgentPointer cam::Environment::get(const std::string& p_id) const {
+cam::AgentPointer cam::Environment::get(const AgentId& p_id) const {
 	return m_agent_collection.get(p_id);
 }
 
@@ -68,23 +75,27 @@ const cam::AgentPointer& cam::Environment::random_agent() const {
 	return m_agent_collection.random_agent();
 }
 
+std::vector<cam::AgentPointer> cam::Environment::random_agents(const size_t p_count) const {
+	return m_agent_collection.random_agents(p_count);
+}
+
 void cam::Environment::remove(const AgentPointer& p_agent) {
 	m_agent_collection.remove(p_agent->get_id());
 }
 
-void cam::Environment::remove(const std::string& p_agent_id) {
-	remove(m_agent_collection.get(p_agent_id));
+void cam::Environment::remove(const AgentId& p_agent_id) {
+	m_agent_collection.remove(p_agent_id);
 }
 
 void
-cam::Environment::send(const std::string& p_sender_id, const std::string& p_receiver_id, const uint8_t* p_message,
+cam::Environment::send(const AgentId& p_sender_id, const AgentId& p_receiver_id, const uint8_t* p_message,
 					   const size_t& p_length, const MessageBinaryFormat& p_binary_format,
 					   const bool p_from_remote) const {
 	if (const AgentPointer& l_agent = m_agent_collection.get(p_receiver_id); l_agent) {
 		if (l_agent->is_dead()) {
 			return;
 		}
-		l_agent->post(std::make_shared<Message>(p_sender_id, p_receiver_id, p_message, p_length, p_binary_format));
+		l_agent->post(Message::create(p_sender_id, p_receiver_id, p_message, p_length, p_binary_format));
 	} else if (m_remote_client && !p_from_remote) {
 		const json& l_data = {
 				{"sender_id",     p_sender_id},
@@ -98,46 +109,47 @@ cam::Environment::send(const std::string& p_sender_id, const std::string& p_rece
 	}
 }
 
-void cam::Environment::send_by_name(const std::string& p_sender_id, const std::string& p_receiver_name,
-									const uint8_t* p_message, const size_t& p_length, const bool p_is_fragment,
-									const bool p_first_only, const MessageBinaryFormat& p_binary_format,
-									const bool p_from_remote) const {
-	// MSVC: no compatible
-	/*for (auto l_filtered_elements =
-			m_agent_collection.m_agents_by_name | std::views::filter([p_is_fragment, p_receiver_name](auto& p_value) {
-				if (p_is_fragment) {
-					return p_value.first.find(p_receiver_name) != std::string::npos;
-				}
-				return p_value.first == p_receiver_name;
-			}); const auto& [l_name, l_id] : l_filtered_elements) {
-		const auto& l_agent = m_agent_collection.get(l_id);
+void cam::Environment::send(const AgentId& p_sender_id, const AgentId& p_receiver_id, ObjectPointer p_object) const {
+	if (const AgentPointer& l_agent = m_agent_collection.get(p_receiver_id); l_agent) {
 		if (l_agent->is_dead()) {
-			continue;
-		}
-
-		l_agent->post(std::make_shared<Message>(p_sender_id, l_id, p_message, p_length, p_binary_format));
-		if (p_first_only) {
-			break;
-		}
-	}*/
-	auto l_filtered_elements =
-		m_agent_collection.m_agents_by_name | std::views::filter([p_is_fragment, p_receiver_name](auto& p_value) {
-		if (p_is_fragment) {
-			return p_value.first.find(p_receiver_name) != std::string::npos;
+			return;
 		}
-		return p_value.first == p_receiver_name;
-			});
+		l_agent->post(Message::create(p_sender_id, p_receiver_id, std::move(p_object)));
+	} else if (m_remote_client) {
+		const auto& l_binary_data = cam::Message::to_binary(p_object->content());
+		send(p_sender_id, p_receiver_id, l_binary_data.data(), l_binary_data.size(), MessageBinaryFormat::MessagePack);
+	}
+}
 
-	for (auto it = std::ranges::begin(l_filtered_elements); it != std::ranges::end(l_filtered_elements); ++it) {
-		const auto& [l_name, l_id] = *it;
-		const auto& l_agent = m_agent_collection.get(l_id);
-		if (l_agent->is_dead()) {
-			continue;
+void cam::Environment::send_by_name(const AgentId& p_sender_id, const std::string& p_receiver_name,
+									const uint8_t* p_message, const size_t& p_length, const bool p_is_fragment,
+									const bool p_first_only, const MessageBinaryFormat& p_binary_format,
+									const bool p_from_remote) const {
+	// Shared by every receiver
+	const PayloadPointer& l_payload = MessagePayload::create(p_message, p_length);
+	if (p_is_fragment) {
+		for (const AgentId& l_id: m_agent_collection.get_by_fragment_name(p_receiver_name)) {
+			const auto& l_agent = m_agent_collection.get(l_id);
+			if (!l_agent || l_agent->is_dead()) {
+				continue;
+			}
+			l_agent->post(Message::create(p_sender_id, l_id, l_payload, p_binary_format));
+			if (p_first_only) {
+				break;
+			}
 		}
 
-		l_agent->post(std::make_shared<Message>(p_sender_id, l_id, p_message, p_length, p_binary_format));
-		if (p_first_only) {
-			break;
+		// Exact name: one lookup, receivers already resolved to handles
+	} else {
+		for (const AgentHandle& l_handle: m_agent_collection.get_handles_by_name(p_receiver_name)) {
+			const auto& l_agent = m_agent_collection.get(l_handle);
+			if (!l_agent || l_agent->is_dead()) {
+				continue;
+			}
+			l_agent->post(Message::create(p_sender_id, l_agent->get_id(), l_payload, p_binary_format));
+			if (p_first_only) {
+				break;
+			}
 		}
 	}
 
@@ -155,11 +167,13 @@ void cam::Environment::send_by_name(const std::string& p_sender_id, const std::s
 	}
 }
 
-void cam::Environment::broadcast(const std::string& p_sender_id, const uint8_t* p_message, const size_t& p_length,
+void cam::Environment::broadcast(const AgentId& p_sender_id, const uint8_t* p_message, const size_t& p_length,
 								 const MessageBinaryFormat& p_binary_format, const bool p_from_remote) const {
-	for (auto& [l_id, l_agent]: m_agent_collection.m_agents) {
-		if (l_id != p_sender_id && !l_agent->is_dead()) {
-			l_agent->post(std::make_shared<Message>(p_sender_id, l_id, p_message, p_length, p_binary_format));
+	// Shared by every receiver
+	const PayloadPointer& l_payload = MessagePayload::create(p_message, p_length);
+	for (const AgentPointer& l_agent: m_agent_collection.m_agents) {
+		if (!l_agent->is_dead() && l_agent->get_id() != p_sender_id) {
+			l_agent->post(Message::create(p_sender_id, l_agent->get_id(), l_payload, p_binary_format));
 		}
 	}
 	if (m_remote_client && !p_from_remote) {
@@ -186,6 +200,11 @@ void cam::Environment::start() {
 		if (m_agent_collection.count() == 0) {
 			break;
 		}
+
+		// Reactive and Asynchronous: without a maximum number of turns, stop when every agent is idle
+		if (m_no_turns == 0 && m_agent_collection.is_reactive() && !m_agent_collection.has_scheduled_agents()) {
+			break;
+		}
 	}
 
 	simulation_finished();
@@ -195,21 +214,16 @@ size_t cam::Environment::agents_count() const {
 	return m_agent_collection.count();
 }
 
-std::vector<std::string>
+std::vector<cam::AgentId>
 cam::Environment::get_agents_by_name(const std::string& p_name, const bool p_first_only) const {
-	std::vector<std::string> l_returned_agents;
-	for (const auto& [l_id, l_agent]: m_agent_collection.m_agents) {
-		if (l_agent->get_name() == p_name) {
-			l_returned_agents.push_back(l_id);
-			if (p_first_only) {
-				break;
-			}
-		}
+	const std::span<const AgentId> l_agents = m_agent_collection.get_by_name(p_name);
+	if (p_first_only && !l_agents.empty()) {
+		return {l_agents.front()};
 	}
-	return l_returned_agents;
+	return {l_agents.begin(), l_agents.end()};
 }
 
-std::optional<std::string> cam::Environment::get_first_agent_by_name(const std::string& p_name) const {
+std::optional<cam::AgentId> cam::Environment::get_first_agent_by_name(const std::string& p_name) const {
 	const auto& l_agents = get_agents_by_name(p_name, true);
 	if (l_agents.empty()) {
 		return {};
@@ -217,26 +231,29 @@ std::optional<std::string> cam::Environment::get_first_agent_by_name(const std::
 	return l_agents[0];
 }
 
-std::optional<std::string> cam::Environment::get_agent_name(const std::string& p_id) const {
-	const auto& l_agent = m_agent_collection.m_agents.find(p_id);
-	if (l_agent == m_agent_collection.m_agents.end()) {
+std::optional<std::string> cam::Environment::get_agent_name(const AgentId& p_id) const {
+	const auto& l_agent = m_agent_collection.get(p_id);
+	if (!l_agent) {
 		return {};
 	}
-	return l_agent->second->get_name();
+	return l_agent->get_name();
 }
 
-std::vector<std::string>
+std::optional<cam::AgentId> cam::Environment::get_agent_id(const AgentHandle& p_handle) const {
+	const auto& l_agent = m_agent_collection.get(p_handle);
+	if (!l_agent) {
+		return {};
+	}
+	return l_agent->get_id();
+}
+
+std::vector<cam::AgentId>
 cam::Environment::get_filtered_agents(const std::string& p_fragment_name, const bool p_first_only) const {
-	std::vector<std::string> l_returned_agents;
-	for (const auto& [l_id, l_agent]: m_agent_collection.m_agents) {
-		if (l_agent->get_name().find(p_fragment_name) != std::string::npos) {
-			l_returned_agents.push_back(l_agent->get_id());
-			if (p_first_only) {
-				break;
-			}
-		}
+	std::vector<AgentId> l_agents = m_agent_collection.get_by_fragment_name(p_fragment_name);
+	if (p_first_only && l_agents.size() > 1) {
+		l_agents.resize(1);
 	}
-	return l_returned_agents;
+	return l_agents;
 }
 
 [[nodiscard]] std::string cam::Environment::get_id() const {
@@ -257,29 +274,193 @@ void cam::Environment::move(const std::stringstream& p_agent_stream, const json&
 	m_remote_client->post_agent(p_environment_id, cam::Message::to_binary(l_message_to_send));
 }
 
+void cam::Environment::set_spatial_perception(const double p_cell_size, const std::string& p_x_key,
+											  const std::string& p_y_key) {
+	m_agent_collection.set_snapshot_outdated();
+	m_spatial_grid.set_cell_size(p_cell_size);
+	m_position_x_key = p_x_key;
+	m_position_y_key = p_y_key;
+}
+
+cam::ObservableKey cam::Environment::register_observable(const std::string& p_name) {
+	m_agent_collection.set_snapshot_outdated();
+	return m_agent_collection.m_observable_columns.intern(p_name);
+}
+
+std::optional<cam::ObservableKey> cam::Environment::get_observable_key(const std::string& p_name) const {
+	return m_agent_collection.m_observable_columns.find(p_name);
+}
+
+double cam::Environment::get_observable(const AgentHandle& p_handle, const ObservableKey p_key) const {
+	if (!m_agent_collection.contains(p_handle)) {
+		return ObservableColumns::s_missing;
+	}
+	return m_agent_collection.m_observable_columns.get_published(p_key, p_handle.m_slot);
+}
+
+std::vector<cam::AgentHandle> cam::Environment::get_agents_in_range(const ObservableKey p_key, const double p_min,
+																	 const double p_max,
+																	 const AgentHandle& p_excluded) const {
+	return select_agents(ColumnQuery().where_in_range(p_key, p_min, p_max), p_excluded);
+}
+
+std::vector<cam::AgentHandle> cam::Environment::select_agents(const ColumnQuery& p_query,
+															   const AgentHandle& p_excluded) const {
+	std::vector<AgentHandle> l_handles;
+	if (p_query.empty()) {
+		for (const AgentPointer& l_agent: m_agent_collection.m_agents) {
+			if (l_agent->m_handle.m_slot != p_excluded.m_slot) {
+				l_handles.push_back(l_agent->m_handle);
+			}
+		}
+		return l_handles;
+	}
+
+	// Released slots hold NaN: they never match
+	std::vector<std::uint64_t> l_mask;
+	p_query.evaluate(m_agent_collection.m_observable_columns, l_mask);
+	for (size_t l_word = 0; l_word < l_mask.size(); l_word++) {
+		for (std::uint64_t l_bits = l_mask[l_word]; l_bits != 0; l_bits &= l_bits - 1) {
+			const auto l_slot = static_cast<std::uint32_t>(l_word * 64 + std::countr_zero(l_bits));
+			if (l_slot != p_excluded.m_slot) {
+				l_handles.push_back({l_slot, m_agent_collection.m_slots[l_slot].m_generation});
+			}
+		}
+	}
+	return l_handles;
+}
+
 const std::vector<cam::ObservablesPointer>
 cam::Environment::get_list_of_observable_agents(const Agent* p_perceiving_agent) const {
+	std::vector<std::uint32_t> l_indexes;
+	get_observable_indexes(p_perceiving_agent, l_indexes);
 	std::vector<cam::ObservablesPointer> l_observable_agent_list;
+	l_observable_agent_list.reserve(l_indexes.size());
+	for (const std::uint32_t l_index: l_indexes) {
+		l_observable_agent_list.push_back(m_observed_agents[l_index].m_observables);
+	}
+	return l_observable_agent_list;
+}
 
-	// Map id:agent
-	for (auto& [l_id, l_agent]: m_agent_collection.m_agents) {
-		if (l_agent->is_dead() || l_id == p_perceiving_agent->get_id()) {
-			continue;
-		}
-		const auto& l_observable = l_agent->get_observables();
-		if (l_observable->empty()) {
-			continue;
+void cam::Environment::update_delta_perception(const Agent* p_perceiving_agent, DeltaPerception& p_delta) const {
+	p_delta.begin();
+	const PerceptionQuery& l_query = p_perceiving_agent->get_perception_query();
+	const double l_radius = m_spatial_grid.is_enabled() ? p_perceiving_agent->get_perception_radius() : 0;
+	const bool l_is_input_changed = p_delta.update_input(p_perceiving_agent->m_observables_version, l_radius, l_query);
+	if (!l_is_input_changed && p_delta.get_snapshot() == m_snapshot_version) {
+		return;
+	}
+
+	// Perceive everything again if the perception changed, or if too many agents changed
+	const auto& l_first_change = std::ranges::upper_bound(m_observed_changes, p_delta.get_snapshot(), {},
+														  &ObservedChange::m_snapshot);
+	if (l_is_input_changed || p_delta.get_snapshot() < m_observed_changes_start ||
+		static_cast<size_t>(m_observed_changes.end() - l_first_change) > m_observed_agents.size()) {
+		std::vector<std::uint32_t> l_indexes;
+		get_observable_indexes(p_perceiving_agent, l_indexes);
+		for (const std::uint32_t l_index: l_indexes) {
+			const ObservedAgent& l_observed = m_observed_agents[l_index];
+			p_delta.perceive(l_observed.m_handle, l_observed.m_agent->get_id(), l_observed.m_version,
+							 l_observed.m_observables);
 		}
+		p_delta.forget_unperceived();
+		p_delta.set_snapshot(m_snapshot_version);
+		return;
+	}
 
-		if (p_perceiving_agent->perception_filter(l_observable)) {
-			l_observable_agent_list.push_back(l_agent->get_observables());
+	// Otherwise only the agents changed since the last perception are checked again (the position of the
+	// perceiving agent did not change, without position nothing is perceived)
+	double l_x = 0;
+	double l_y = 0;
+	if (l_radius <= 0 || get_position(*p_perceiving_agent->get_observables(), l_x, l_y)) {
+		double l_observed_x;
+		double l_observed_y;
+		for (auto l_it = l_first_change; l_it != m_observed_changes.end(); ++l_it) {
+			if (const std::uint32_t l_index = m_observed_indexes[l_it->m_slot]; l_index != s_not_observed) {
+				const ObservedAgent& l_observed = m_observed_agents[l_index];
+				if ((l_radius <= 0 || (get_position(*l_observed.m_observables, l_observed_x, l_observed_y) &&
+									   (l_observed_x - l_x) * (l_observed_x - l_x) +
+									   (l_observed_y - l_y) * (l_observed_y - l_y) <= l_radius * l_radius)) &&
+					is_perceived(p_perceiving_agent, l_query, l_observed)) {
+					p_delta.perceive(l_observed.m_handle, l_observed.m_agent->get_id(), l_observed.m_version,
+									 l_observed.m_observables);
+					continue;
+				}
+			}
+			p_delta.forget(l_it->m_slot);
 		}
 	}
-	return l_observable_agent_list;
+	p_delta.set_snapshot(m_snapshot_version);
+}
+
+bool cam::Environment::is_perceived(const Agent* p_perceiving_agent, const PerceptionQuery& p_query,
+									const ObservedAgent& p_observed) const {
+	if (p_observed.m_agent == p_perceiving_agent) {
+		return false;
+	}
+	return p_query.empty() ? p_perceiving_agent->perception_filter(p_observed.m_observables)
+						   : p_query.matches(*p_observed.m_observables);
 }
 
+void cam::Environment::get_observable_indexes(const Agent* p_perceiving_agent,
+											  std::vector<std::uint32_t>& p_indexes) const {
+	const PerceptionQuery& l_query = p_perceiving_agent->get_perception_query();
+	const auto& l_filter = [this, &p_indexes, &l_query, p_perceiving_agent](const std::uint32_t p_index) {
+		if (is_perceived(p_perceiving_agent, l_query, m_observed_agents[p_index])) {
+			p_indexes.push_back(p_index);
+		}
+	};
+
+	// Spatial perception: only the agents in the perception radius are candidates
+	double l_x;
+	double l_y;
+	if (const double l_radius = p_perceiving_agent->get_perception_radius();
+			l_radius > 0 && m_spatial_grid.is_enabled()) {
+		if (!get_position(*p_perceiving_agent->get_observables(), l_x, l_y)) {
+			return;
+		}
+		std::vector<std::uint32_t> l_candidates;
+		m_spatial_grid.for_each_in_radius(l_x, l_y, l_radius, [&l_candidates](const std::uint32_t p_index) {
+			l_candidates.push_back(p_index);
+		});
+		std::ranges::sort(l_candidates);
+		for (const std::uint32_t l_index: l_candidates) {
+			l_filter(l_index);
+		}
+		return;
+	}
+
+	// Declarative perception: only the agents selected by an index are candidates, the predicate of the
+	// index is not checked again
+	size_t l_indexed_predicate;
+	if (std::vector<std::uint32_t> l_candidates;
+			!l_query.empty() && m_observables_index.select(l_query, l_candidates, l_indexed_predicate)) {
+		for (const std::uint32_t l_index: l_candidates) {
+			const ObservedAgent& l_observed = m_observed_agents[l_index];
+			if (l_observed.m_agent != p_perceiving_agent &&
+				l_query.matches(*l_observed.m_observables, l_indexed_predicate)) {
+				p_indexes.push_back(l_index);
+			}
+		}
+		return;
+	}
+
+	for (std::uint32_t l_index = 0; l_index < m_observed_agents.size(); l_index++) {
+		l_filter(l_index);
+	}
+}
 
 void cam::Environment::run_turn(const int p_turn) {
+	// Nothing reads the snapshot without observing agent nor typed observable, it stays outdated until then.
+	// Reactive and Asynchronous: idle agents cost nothing, the snapshot is kept while nothing changed
+	if ((m_agent_collection.m_observing_agent_count > 0 || m_agent_collection.m_observable_columns.size() > 0) &&
+		(!m_agent_collection.is_reactive() ||
+		 m_agent_collection.m_is_snapshot_outdated.exchange(false, std::memory_order_relaxed))) {
+		update_observables_snapshot();
+		if (m_spatial_grid.is_enabled()) {
+			update_spatial_grid();
+		}
+	}
 	m_agent_collection.run_turn();
 	if (m_delay_after_turn) {
 		std::this_thread::sleep_for(std::chrono::milliseconds(m_delay_after_turn));
@@ -287,6 +468,88 @@ void cam::Environment::run_turn(const int p_turn) {
 	turn_finished(p_turn);
 }
 
+void cam::Environment::update_observables_snapshot() {
+	m_agent_collection.m_observable_columns.publish();
+	m_snapshot_version++;
+	std::swap(m_observed_agents, m_previous_observed_agents);
+	m_observed_agents.clear();
+	m_observed_indexes.resize(m_agent_collection.m_slots.size(), s_not_observed);
+	m_observables_index.clear();
+	bool l_has_queries = false;
+	for (const AgentPointer& l_agent: m_agent_collection.m_agents) {
+		if (l_agent->is_dead()) {
+			continue;
+		}
+		if (l_agent->is_using_observables() && !l_agent->m_perception_query.empty()) {
+			m_observables_index.add_keys(l_agent->m_perception_query);
+			l_has_queries = true;
+		}
+		if (!l_agent->m_observables->empty()) {
+			// New agent in the slot or new observables
+			const AgentHandle& l_handle = l_agent->m_handle;
+			const std::uint32_t l_previous_index = m_observed_indexes[l_handle.m_slot];
+			if (l_previous_index == s_not_observed ||
+				m_previous_observed_agents[l_previous_index].m_handle != l_handle ||
+				m_previous_observed_agents[l_previous_index].m_version != l_agent->m_observables_version) {
+				m_observed_changes.push_back({m_snapshot_version, l_handle.m_slot});
+			}
+			m_observed_indexes[l_handle.m_slot] = static_cast<std::uint32_t>(m_observed_agents.size());
+			m_observed_agents.push_back({l_agent.get(), l_handle, l_agent->m_observables_version, l_agent->m_observables});
+		}
+	}
+
+	// Agents no longer observed (their slot now points to a previous index)
+	for (const ObservedAgent& l_previous: m_previous_observed_agents) {
+		const std::uint32_t l_slot = l_previous.m_handle.m_slot;
+		if (const std::uint32_t l_index = m_observed_indexes[l_slot];
+				l_index >= m_observed_agents.size() || m_observed_agents[l_index].m_handle.m_slot != l_slot) {
+			m_observed_indexes[l_slot] = s_not_observed;
+			m_observed_changes.push_back({m_snapshot_version, l_slot});
+		}
+	}
+	m_previous_observed_agents.clear();
+
+	// Keep the changes of the last snapshots only, the older delta perceptions are computed again
+	if (const size_t l_max_changes = std::max(m_observed_agents.size(), s_min_observed_changes);
+			m_observed_changes.size() > 2 * l_max_changes) {
+		const std::uint64_t l_start = (m_observed_changes.end() - l_max_changes)->m_snapshot - 1;
+		m_observed_changes.erase(m_observed_changes.begin(),
+								 std::ranges::upper_bound(m_observed_changes, l_start, {}, &ObservedChange::m_snapshot));
+		m_observed_changes_start = l_start;
+	}
+
+	// Index the keys used by the perception queries
+	if (l_has_queries) {
+		for (size_t l_index = 0; l_index < m_observed_agents.size(); l_index++) {
+			m_observables_index.insert(static_cast<std::uint32_t>(l_index), *m_observed_agents[l_index].m_observables);
+		}
+		m_observables_index.build();
+	}
+}
+
+void cam::Environment::update_spatial_grid() {
+	double l_x;
+	double l_y;
+	for (size_t l_index = 0; l_index < m_observed_agents.size(); l_index++) {
+		if (get_position(*m_observed_agents[l_index].m_observables, l_x, l_y)) {
+			m_spatial_grid.insert(l_x, l_y, static_cast<std::uint32_t>(l_index));
+		}
+	}
+	m_spatial_grid.build();
+}
+
+bool cam::Environment::get_position(const Observables& p_observables, double& p_x, double& p_y) const {
+	const auto& l_x_it = p_observables.find(m_position_x_key);
+	const auto& l_y_it = p_observables.find(m_position_y_key);
+	if (l_x_it == p_observables.end() || l_y_it == p_observables.end() ||
+		!l_x_it->second.is_number() || !l_y_it->second.is_number()) {
+		return false;
+	}
+	p_x = l_x_it->second.get<double>();
+	p_y = l_y_it->second.get<double>();
+	return std::isfinite(p_x) && std::isfinite(p_y);
+}
+
 //###############################################################
 //	Remote handlers
 //###############################################################
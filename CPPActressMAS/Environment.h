@@ -29,6 +29,9 @@ using json = nlohmann::json;
 #include "AgentCollection.h"
 #include "Message.h"
 #include "Agent.h"
+#include "ColumnQuery.h"
+#include "ObservablesIndex.h"
+#include "SpatialGrid.h"
 
 /**
  * CPPActressMAS
@@ -41,7 +44,9 @@ namespace cam {
 	enum class EnvironmentMasMode {
 		Parallel,
 		Sequential,
-		SequentialRandom
+		SequentialRandom,
+		Reactive,
+		Asynchronous
 	};
 
 	class Agent;
@@ -59,6 +64,7 @@ namespace cam {
 		friend PahoWrapper;
 		friend Callback;
 		friend SubscribeActionListener;
+		friend Agent;
 
 	private:
 		/**
@@ -91,6 +97,81 @@ namespace cam {
 		 **/
 		json m_environement_data;
 
+		/**
+		 * Observables of an agent at the start of the turn
+		 **/
+		struct ObservedAgent {
+			const Agent* m_agent;
+			AgentHandle m_handle;
+			std::uint64_t m_version;
+			ObservablesPointer m_observables;
+		};
+
+		/**
+		 * Non-empty observables of the alive agents, taken at the start of each turn. Every agent
+		 * perceives this snapshot, the agents changing their observables meanwhile work on a copy.
+		 **/
+		std::vector<ObservedAgent> m_observed_agents;
+
+		/**
+		 * Observed agents of the previous snapshot, to find the changes (reused across turns)
+		 **/
+		std::vector<ObservedAgent> m_previous_observed_agents;
+
+		/**
+		 * Not observed slot
+		 **/
+		static constexpr std::uint32_t s_not_observed = std::numeric_limits<std::uint32_t>::max();
+
+		/**
+		 * Index in m_observed_agents of each agent slot, s_not_observed if the agent is not observed
+		 **/
+		std::vector<std::uint32_t> m_observed_indexes;
+
+		/**
+		 * Version of the snapshot, incremented by each update
+		 **/
+		std::uint64_t m_snapshot_version;
+
+		/**
+		 * Slot changed by a snapshot: agent observed for the first time, new observables or no longer observed
+		 **/
+		struct ObservedChange {
+			std::uint64_t m_snapshot;
+			std::uint32_t m_slot;
+		};
+
+		/**
+		 * Changes of the last snapshots, oldest first: the delta perceptions only check these slots again
+		 **/
+		std::vector<ObservedChange> m_observed_changes;
+
+		/**
+		 * Oldest snapshot version from which m_observed_changes is complete
+		 **/
+		std::uint64_t m_observed_changes_start;
+
+		/**
+		 * Minimal number of changes kept
+		 **/
+		static constexpr size_t s_min_observed_changes = 1024;
+
+		/**
+		 * Indexes of the observed agents for the keys of the perception queries, rebuilt each turn
+		 **/
+		ObservablesIndex m_observables_index;
+
+		/**
+		 * Positions of the observed agents, rebuilt each turn (spatial perception)
+		 **/
+		SpatialGrid m_spatial_grid;
+
+		/**
+		 * Observables keys of the position (spatial perception)
+		 **/
+		std::string m_position_x_key;
+		std::string m_position_y_key;
+
 	public:
 
 		/**
@@ -102,8 +183,14 @@ namespace cam {
 		 * simulation runs indefinitely, or until there are no more agents in the
 		 * environment.
 		 * @param p_mode Whether agent behaviors are executed in parallel,
-		 * sequentially or sequentially with random order. The code of a single agent
-		 * in a turn is always executed sequentially.
+		 * sequentially or sequentially with random order. In Reactive mode, only the
+		 * agents that received messages or asked to wake up are run (in parallel). In
+		 * Asynchronous mode, they are run as soon as they receive a message, without
+		 * waiting for the next turn: a turn ends when every agent is idle or after at
+		 * least one run per agent, to add and remove agents and call turn_finished.
+		 * In both modes, without a maximum number of turns the simulation also stops
+		 * when no agent is scheduled. The code of a single agent is always executed
+		 * sequentially.
 		 * @param p_delay_after_turn A delay (in milliseconds) after each turn.
 		 * @param p_seed A random number generator seed for non-deterministic but
 		 * repeatable experiments.
@@ -122,7 +209,7 @@ namespace cam {
 		 * @return Id of the agent
 		 **/
 		template<ConceptAgent T>
-		const std::string& add(auto&& ... p_args) {
+		const AgentId& add(auto&& ... p_args) {
 			const auto& l_agent = AgentPointer(new T(std::forward<decltype(p_args)>(p_args)...));
 			l_agent->set_environment(this);
 			m_agent_collection.add(l_agent);
@@ -135,7 +222,7 @@ namespace cam {
 		 * @return Id of the agent
 		 **/
 		template<ConceptAgent T>
-		const std::string& add(std::stringstream& p_stream) {
+		const AgentId& add(std::stringstream& p_stream) {
 			const auto& l_agent = AgentPointer(new T());
 			l_agent->set_environment(this);
 			l_agent->deserialize_from_stream<T>(p_stream);
@@ -163,7 +250,7 @@ namespace cam {
 		 *
 		 * @param p_agent_id The id of the agent to be removed
 		 **/
-		void remove(const std::string& p_agent_id);
+		void remove(const AgentId& p_agent_id);
 
 		/**
 		 * Sends a message from the outside of the multiagent system. Whenever
@@ -177,10 +264,19 @@ namespace cam {
 		 * @param p_binary_format The message binary format
 		 * @param p_from_remote If from remote, do not broadcast remotely
 		 **/
-		void send(const std::string& p_sender_id, const std::string& p_receiver_id, const uint8_t* p_message,
+		void send(const AgentId& p_sender_id, const AgentId& p_receiver_id, const uint8_t* p_message,
 				  const size_t& p_length, const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::RAW,
 				  bool p_from_remote = false) const;
 
+		/**
+		 * Sends a typed message. The object is posted as is to a local receiver, it is encoded
+		 * with MessagePack only when forwarded to a remote environment.
+		 * @param p_sender_id The sender ID
+		 * @param p_receiver_id The receiver ID
+		 * @param p_object The object to be sent
+		 **/
+		void send(const AgentId& p_sender_id, const AgentId& p_receiver_id, ObjectPointer p_object) const;
+
 		/**
 		 * Sends a message by name.
 		 * @param p_sender_id The sender ID
@@ -192,7 +288,7 @@ namespace cam {
 		 * @param p_binary_format The message binary format
 		 * @param p_from_remote If from remote, do not broadcast remotely
 		 **/
-		void send_by_name(const std::string& p_sender_id, const std::string& p_receiver_name, const uint8_t* p_message,
+		void send_by_name(const AgentId& p_sender_id, const std::string& p_receiver_name, const uint8_t* p_message,
 						  const size_t& p_length, bool p_is_fragment, bool p_first_only,
 						  const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::RAW,
 						  bool p_from_remote = false) const;
@@ -205,7 +301,7 @@ namespace cam {
 		 * @param p_binary_format The message binary format
 		 * @param p_from_remote If from remote, do not broadcast remotely
 		 **/
-		void broadcast(const std::string& p_sender_id, const uint8_t* p_message, const size_t& p_length,
+		void broadcast(const AgentId& p_sender_id, const uint8_t* p_message, const size_t& p_length,
 					   const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::RAW,
 					   bool p_from_remote = false) const;
 
@@ -225,7 +321,7 @@ namespace cam {
 		 * @param p_first_only if true the first found
 		 * @return All agents by name
 		 **/
-		[[nodiscard]] std::vector<std::string>
+		[[nodiscard]] std::vector<AgentId>
 		get_agents_by_name(const std::string& p_name, bool p_first_only = false) const;
 
 		/**
@@ -233,14 +329,21 @@ namespace cam {
 		 * @param p_name the name of agent
 		 * @return All agents by name
 		 **/
-		[[nodiscard]] std::optional<std::string> get_first_agent_by_name(const std::string& p_name) const;
+		[[nodiscard]] std::optional<AgentId> get_first_agent_by_name(const std::string& p_name) const;
 
 		/**
 		 * Get agent name by id
 		 * @param p_id the name of agent
 		 * @return Agents name
 		 **/
-		[[nodiscard]] std::optional<std::string> get_agent_name(const std::string& p_id) const;
+		[[nodiscard]] std::optional<std::string> get_agent_name(const AgentId& p_id) const;
+
+		/**
+		 * Get agent id by handle
+		 * @param p_handle the handle of agent
+		 * @return Agent id, empty if the handle is no longer valid
+		 **/
+		[[nodiscard]] std::optional<AgentId> get_agent_id(const AgentHandle& p_handle) const;
 
 		/**
 		 * Get all agents by fragment name
@@ -248,7 +351,7 @@ namespace cam {
 		 * @param p_first_only if true the first found
 		 * @return All agents by fragment name
 		 **/
-		[[nodiscard]] std::vector<std::string>
+		[[nodiscard]] std::vector<AgentId>
 		get_filtered_agents(const std::string& p_fragment_name, bool p_first_only = false) const;
 
 		/**
@@ -282,6 +385,91 @@ namespace cam {
 			m_environement_data.erase(p_key);
 		}
 
+		/**
+		 * Set the number of agents run sequentially by one task in parallel mode. Small agents
+		 * should be batched so that the scheduling cost does not exceed their own run time.
+		 * @param p_grain_size Number of agents per task, 0 (default) to adapt it to the
+		 * run time of the agents measured during the previous turn
+		 **/
+		void set_grain_size(const size_t p_grain_size) {
+			m_agent_collection.set_grain_size(p_grain_size);
+		}
+
+		/**
+		 * Split the agents into shards in parallel mode. Each shard is run and maintained (dead agents
+		 * removed, new agents inserted) by the same worker every turn. New agents are spread between
+		 * the shards, which are balanced again when their sizes diverge. Call it before starting the
+		 * simulation.
+		 * @param p_shard_count Number of shards, 1 (default) to balance the agents dynamically
+		 **/
+		void set_shard_count(const size_t p_shard_count) {
+			m_agent_collection.set_shard_count(p_shard_count);
+		}
+
+		/**
+		 * Add the agents created by an agent to the shard of their creator (the same worker runs them
+		 * the next turns, until the shards are balanced again) instead of spreading them.
+		 * @param p_enabled True to enable
+		 **/
+		void set_creator_shard(const bool p_enabled = true) {
+			m_agent_collection.set_creator_shard(p_enabled);
+		}
+
+		/**
+		 * Enable spatial perception: agents publish their position in their observables and an agent
+		 * with a perception radius only perceives (and filters) the agents within this radius.
+		 * Agents without perception radius still perceive every agent.
+		 * @param p_cell_size Size of the grid cells, about the usual perception radius, 0 to disable
+		 * @param p_x_key Observable holding the X position
+		 * @param p_y_key Observable holding the Y position
+		 **/
+		void set_spatial_perception(double p_cell_size, const std::string& p_x_key = "x",
+									const std::string& p_y_key = "y");
+
+		/**
+		 * Register a typed observable: a numeric value stored in a column shared by all the agents,
+		 * read and written by key instead of by name. Register the keys before starting the simulation.
+		 * @param p_name Name of the observable
+		 * @return Key of the observable, the same key if already registered
+		 **/
+		ObservableKey register_observable(const std::string& p_name);
+
+		/**
+		 * Get the key of a typed observable
+		 * @param p_name Name of the observable
+		 * @return Key of the observable, empty if not registered
+		 **/
+		[[nodiscard]] std::optional<ObservableKey> get_observable_key(const std::string& p_name) const;
+
+		/**
+		 * Get a typed observable of an agent, as it was at the start of the turn
+		 * @param p_handle Handle of the agent
+		 * @param p_key Key of the observable
+		 * @return The value, NaN if missing or if the handle is no longer valid
+		 **/
+		[[nodiscard]] double get_observable(const AgentHandle& p_handle, ObservableKey p_key) const;
+
+		/**
+		 * Get the agents whose typed observable was in [p_min, p_max] at the start of the turn
+		 * @param p_key Key of the observable
+		 * @param p_min The min value
+		 * @param p_max The max value
+		 * @param p_excluded Agent to skip (the perceiving agent)
+		 * @return Handles of the agents, by slot
+		 **/
+		[[nodiscard]] std::vector<AgentHandle> get_agents_in_range(ObservableKey p_key, double p_min, double p_max,
+																   const AgentHandle& p_excluded = {}) const;
+
+		/**
+		 * Get the agents whose typed observables matched a query at the start of the turn. The query
+		 * is evaluated with vectorized scans of the columns, not agent by agent.
+		 * @param p_query The query, every agent matches an empty query
+		 * @param p_excluded Agent to skip (the perceiving agent)
+		 * @return Handles of the agents
+		 **/
+		[[nodiscard]] std::vector<AgentHandle> select_agents(const ColumnQuery& p_query,
+															 const AgentHandle& p_excluded = {}) const;
+
 		/**
 		 * Move agent.
 		 * @param p_agent_stream The agent stream
@@ -310,7 +498,8 @@ namespace cam {
 		virtual void turn_finished(int) {}
 
 		/**
-		 * Get the list of observable agents for an agent and its perception filter.
+		 * Get the list of observable agents for an agent and its perception query (or filter), as
+		 * they were at the start of the turn.
 		 * @param p_perceiving_agent Perceiving agent
 		 **/
 		const std::vector<cam::ObservablesPointer> get_list_of_observable_agents(const Agent* p_perceiving_agent) const;
@@ -355,7 +544,7 @@ namespace cam {
 		 * @param p_agent The concurrent agent that will be added
 		 * @return Id of the agent
 		 **/
-		const std::string& add(AgentPointer&& p_agent);
+		const AgentId& add(AgentPointer&& p_agent);
 
 		/**
 		 * Stops the execution of the agent and removes it from the environment. Use
@@ -368,17 +557,30 @@ namespace cam {
 		void remove(const AgentPointer& p_agent);
 
 		/**
-		 * Returns the id of a randomly selected agent from the environment
-		 * @retrun Randomly selected agent
+		 * Returns a randomly selected alive agent from the environment
+		 * @retrun Randomly selected agent, nullptr if every agent is stopped
 		 **/
 		[[nodiscard]] const AgentPointer& random_agent() const;
 
+		/**
+		 * Returns randomly selected alive agents, without replacement
+		 * @param p_count Number of agents
+		 * @return Randomly selected agents, fewer if there are not enough alive agents
+		 **/
+		[[nodiscard]] std::vector<AgentPointer> random_agents(size_t p_count) const;
+
 		/**
 		 * Get an agent.
 		 * @param p_id Agent ID
 		 * @return Agent pointer
 		 **/
-		AgentPointer get(const std::string& p_id) const;
+		AgentPointer get(const AgentId& p_id) const;
+
+		/**
+		 * Get the typed observables of the agents.
+		 * @return The columns
+		 **/
+		ObservableColumns& get_observable_columns() { return m_agent_collection.m_observable_columns; }
 
 		/**
 		 * Run one turn.
@@ -386,6 +588,49 @@ namespace cam {
 		 **/
 		void run_turn(int p_turn);
 
+		/**
+		 * Take the observables of the agents for this turn.
+		 **/
+		void update_observables_snapshot();
+
+		/**
+		 * True if an agent perceives an observed agent, with its perception query (or filter).
+		 * @param p_perceiving_agent Perceiving agent
+		 * @param p_query Its perception query
+		 * @param p_observed Observed agent
+		 * @return True if perceived
+		 **/
+		bool is_perceived(const Agent* p_perceiving_agent, const PerceptionQuery& p_query,
+						  const ObservedAgent& p_observed) const;
+
+		/**
+		 * Get the observed agents perceived by an agent, with its perception query (or filter).
+		 * @param p_perceiving_agent Perceiving agent
+		 * @param p_indexes Output, indexes in m_observed_agents in ascending order
+		 **/
+		void get_observable_indexes(const Agent* p_perceiving_agent, std::vector<std::uint32_t>& p_indexes) const;
+
+		/**
+		 * Compare the observed agents perceived by an agent with its previous perception.
+		 * @param p_perceiving_agent Perceiving agent
+		 * @param p_delta Previous perception, updated
+		 **/
+		void update_delta_perception(const Agent* p_perceiving_agent, DeltaPerception& p_delta) const;
+
+		/**
+		 * Index the position of the observed agents for this turn.
+		 **/
+		void update_spatial_grid();
+
+		/**
+		 * Read a position from observables.
+		 * @param p_observables The observables
+		 * @param p_x Output X
+		 * @param p_y Output Y
+		 * @return False if there is no numeric position
+		 **/
+		bool get_position(const Observables& p_observables, double& p_x, double& p_y) const;
+
 		//###############################################################
 		//	Remote handlers
 		//###############################################################
@@ -0,0 +1,121 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Reference counted pointer to an object holding its own counter.
+	 * T must provide acquire() and release() (release destroys the object with the last reference).
+	 * Only T can wrap a raw pointer, so every pointed object comes from its own factory.
+	 **/
+	template<typename T>
+	class IntrusivePointer final {
+		friend std::remove_const_t<T>;
+
+	private:
+		/**
+		 * The object.
+		 **/
+		T* m_pointer;
+
+		/**
+		 * Take a new reference on p_pointer.
+		 * @param p_pointer The object
+		 **/
+		explicit IntrusivePointer(T* p_pointer) noexcept :
+				m_pointer(p_pointer) {
+			if (m_pointer) {
+				m_pointer->acquire();
+			}
+		}
+
+	public:
+		/**
+		 * Null pointer.
+		 **/
+		IntrusivePointer() noexcept : m_pointer(nullptr) {}
+
+		IntrusivePointer(std::nullptr_t) noexcept : m_pointer(nullptr) {}
+
+		IntrusivePointer(const IntrusivePointer& p_other) noexcept :
+				m_pointer(p_other.m_pointer) {
+			if (m_pointer) {
+				m_pointer->acquire();
+			}
+		}
+
+		IntrusivePointer(IntrusivePointer&& p_other) noexcept :
+				m_pointer(p_other.m_pointer) {
+			p_other.m_pointer = nullptr;
+		}
+
+		IntrusivePointer& operator=(const IntrusivePointer& p_other) noexcept {
+			if (p_other.m_pointer) {
+				p_other.m_pointer->acquire();
+			}
+			reset();
+			m_pointer = p_other.m_pointer;
+			return *this;
+		}
+
+		IntrusivePointer& operator=(IntrusivePointer&& p_other) noexcept {
+			if (this != &p_other) {
+				reset();
+				m_pointer = p_other.m_pointer;
+				p_other.m_pointer = nullptr;
+			}
+			return *this;
+		}
+
+		/**
+		 * Release the reference.
+		 **/
+		~IntrusivePointer() {
+			reset();
+		}
+
+		/**
+		 * Release the reference now.
+		 **/
+		void reset() noexcept {
+			if (m_pointer) {
+				m_pointer->release();
+				m_pointer = nullptr;
+			}
+		}
+
+		[[nodiscard]] T* get() const noexcept { return m_pointer; }
+
+		T* operator->() const noexcept { return m_pointer; }
+
+		T& operator*() const noexcept { return *m_pointer; }
+
+		explicit operator bool() const noexcept { return m_pointer != nullptr; }
+
+		bool operator==(const IntrusivePointer& p_other) const noexcept = default;
+	};
+
+} // namespace cam
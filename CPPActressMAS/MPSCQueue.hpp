@@ -20,6 +20,7 @@
 
 #include <atomic>
 #include <queue>
+#include <thread>
 #include <cereal/types/queue.hpp> // Serialize queue
 
 /**
@@ -30,6 +31,9 @@ namespace cam {
 	/**
 	 * MPSC (Multiple Producer Single Consumer) lock free queue from CPP Benchmark (serializable)
 	 * https://github.com/chronoxor/CppBenchmark/blob/master/examples/lockfree/mpsc-queue.hpp
+	 * Nodes are recycled through a free list local to each thread: the consumer releases the node
+	 * it has dequeued, the next enqueue done by the same thread reuses it, so there is no heap
+	 * allocation once the free lists are warm.
 	 */
 	template<typename T>
 	class MPSCQueue {
@@ -42,6 +46,29 @@ namespace cam {
 		};
 		typedef char MPSCQueuePad[64];
 
+		/**
+		 * Free nodes of the calling thread
+		 */
+		struct MPSCQueueNodeCache {
+			MPSCQueueNode* m_head = nullptr;
+			size_t m_size = 0;
+
+			~MPSCQueueNodeCache() {
+				while (m_head) {
+					MPSCQueueNode* l_next = m_head->next.load(std::memory_order_relaxed);
+					delete m_head;
+					m_head = l_next;
+				}
+				// Nodes released after the thread cache is gone are deleted
+				m_size = s_max_cached_nodes;
+			}
+		};
+
+		/**
+		 * Maximum number of free nodes kept per thread
+		 */
+		static constexpr size_t s_max_cached_nodes = 4096;
+
 		/**
 		 * Head of the queue
 		 */
@@ -61,7 +88,7 @@ namespace cam {
 		 */
 		MPSCQueue() :
 				m_head_pad{},
-				m_head(new MPSCQueueNode),
+				m_head(allocate_node()),
 				m_tail_pad{},
 				m_tail(m_head.load(std::memory_order_relaxed)) {
 			MPSCQueueNode* l_front = m_head.load(std::memory_order_relaxed);
@@ -74,8 +101,7 @@ namespace cam {
 		~MPSCQueue() {
 			T l_output;
 			while (this->dequeue(l_output)) {}
-			const MPSCQueueNode* l_front = m_head.load(std::memory_order_relaxed);
-			delete l_front;
+			release_node(m_head.load(std::memory_order_relaxed));
 		}
 
 		/**
@@ -83,11 +109,23 @@ namespace cam {
 		 * @param p_input_item new item
 		 */
 		void enqueue(const T& p_input_item) {
-			auto* l_node = new MPSCQueueNode;
+			MPSCQueueNode* l_node = allocate_node();
 			l_node->data = p_input_item;
-			l_node->next.store(nullptr, std::memory_order_relaxed);
-			MPSCQueueNode* l_prev_head = m_head.exchange(l_node, std::memory_order_acq_rel);
-			l_prev_head->next.store(l_node, std::memory_order_release);
+			push(l_node);
+		}
+
+		void enqueue(T&& p_input_item) {
+			MPSCQueueNode* l_node = allocate_node();
+			l_node->data = std::move(p_input_item);
+			push(l_node);
+		}
+
+		/**
+		 * True if no item is pending (consumer side)
+		 * @return true if empty
+		 */
+		[[nodiscard]] bool empty() const {
+			return m_tail.load(std::memory_order_relaxed)->next.load(std::memory_order_acquire) == nullptr;
 		}
 
 		/**
@@ -103,12 +141,58 @@ namespace cam {
 				return false;
 			}
 
-			p_output_item = l_next->data;
+			p_output_item = std::move(l_next->data);
 			m_tail.store(l_next, std::memory_order_release);
-			delete l_tail;
+			release_node(l_tail);
 			return true;
 		}
 
+		/**
+		 * Detach every pending item at once and give them, in order, to p_function.
+		 * Only one atomic exchange is needed, whatever the number of items.
+		 * @param p_function function called with each item (T&&)
+		 * @return number of items
+		 */
+		template<typename F>
+		size_t drain(F&& p_function) {
+			MPSCQueueNode* l_tail = m_tail.load(std::memory_order_relaxed);
+			MPSCQueueNode* l_next = l_tail->next.load(std::memory_order_acquire);
+			if (l_next == nullptr) {
+				return 0;
+			}
+
+			// Only one item, same as dequeue
+			if (l_next->next.load(std::memory_order_acquire) == nullptr) {
+				p_function(std::move(l_next->data));
+				m_tail.store(l_next, std::memory_order_release);
+				release_node(l_tail);
+				return 1;
+			}
+
+			// New producers link after the new stub, the old chain belongs to the consumer
+			MPSCQueueNode* l_stub = allocate_node();
+			l_stub->next.store(nullptr, std::memory_order_relaxed);
+			MPSCQueueNode* l_last = m_head.exchange(l_stub, std::memory_order_acq_rel);
+			m_tail.store(l_stub, std::memory_order_release);
+
+			size_t l_count = 0;
+			release_node(l_tail);
+			while (true) {
+				p_function(std::move(l_next->data));
+				l_count++;
+				if (l_next == l_last) {
+					release_node(l_next);
+					return l_count;
+				}
+				// A producer may not have linked its node yet
+				MPSCQueueNode* l_node = l_next;
+				while ((l_next = l_node->next.load(std::memory_order_acquire)) == nullptr) {
+					std::this_thread::yield();
+				}
+				release_node(l_node);
+			}
+		}
+
 		/**
 		 * Serialize queue
 		 * @param p_archive archive to store queue
@@ -144,6 +228,58 @@ namespace cam {
 		MPSCQueue(const MPSCQueue&) = delete;
 
 		MPSCQueue& operator=(MPSCQueue&) = delete;
+
+	private:
+
+		/**
+		 * Link a node at the head of the queue
+		 * @param p_node the node
+		 */
+		void push(MPSCQueueNode* p_node) {
+			p_node->next.store(nullptr, std::memory_order_relaxed);
+			MPSCQueueNode* l_prev_head = m_head.exchange(p_node, std::memory_order_acq_rel);
+			l_prev_head->next.store(p_node, std::memory_order_release);
+		}
+
+		/**
+		 * Get the thread free list
+		 * @return the free list of the calling thread
+		 */
+		static MPSCQueueNodeCache& node_cache() {
+			thread_local MPSCQueueNodeCache t_cache;
+			return t_cache;
+		}
+
+		/**
+		 * Take a node from the thread free list, allocate it if empty
+		 * @return a node
+		 */
+		static MPSCQueueNode* allocate_node() {
+			MPSCQueueNodeCache& l_cache = node_cache();
+			if (MPSCQueueNode* l_node = l_cache.m_head; l_node) {
+				l_cache.m_head = l_node->next.load(std::memory_order_relaxed);
+				l_cache.m_size--;
+				return l_node;
+			}
+			auto* l_node = new MPSCQueueNode;
+			l_node->next.store(nullptr, std::memory_order_relaxed);
+			return l_node;
+		}
+
+		/**
+		 * Give a node back to the thread free list (its data has already been moved out)
+		 * @param p_node the node
+		 */
+		static void release_node(MPSCQueueNode* p_node) {
+			MPSCQueueNodeCache& l_cache = node_cache();
+			if (l_cache.m_size >= s_max_cached_nodes) {
+				delete p_node;
+				return;
+			}
+			p_node->next.store(l_cache.m_head, std::memory_order_relaxed);
+			l_cache.m_head = p_node;
+			l_cache.m_size++;
+		}
 	};
 
 } // namespace cam
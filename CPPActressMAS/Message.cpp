@@ -18,33 +18,112 @@
 
 #include "Message.h"
 
-cam::Message::Message(std::string p_sender, std::string p_receiver, const json& p_message,
+#include <cstring>
+
+namespace {
+	/**
+	 * Free message memory of the calling thread
+	 */
+	struct MessageStorageCache {
+		static constexpr size_t s_max_size = 8192;
+
+		void* m_head = nullptr;
+		size_t m_size = 0;
+
+		~MessageStorageCache() {
+			while (m_head) {
+				void* l_next = *static_cast<void**>(m_head);
+				::operator delete(m_head);
+				m_head = l_next;
+			}
+			// Memory released after the thread cache is gone is deleted
+			m_size = s_max_size;
+		}
+	};
+
+	thread_local MessageStorageCache t_message_storage_cache;
+
+	/**
+	 * Get a content cached on first access
+	 * @param p_content The cache, null until the first access
+	 * @param p_decode Decode the content
+	 * @return The cached content
+	 */
+	template<typename F>
+	const json& get_cached_content(std::atomic<const json*>& p_content, F&& p_decode) {
+		if (const json* l_content = p_content.load(std::memory_order_acquire); l_content) {
+			return *l_content;
+		}
+
+		// Concurrent readers may both decode, only the first result is kept
+		const json* l_decoded = new json(p_decode());
+		const json* l_expected = nullptr;
+		if (!p_content.compare_exchange_strong(l_expected, l_decoded, std::memory_order_acq_rel,
+											   std::memory_order_acquire)) {
+			delete l_decoded;
+			return *l_expected;
+		}
+		return *l_decoded;
+	}
+}
+
+cam::Message::Message(const AgentId& p_sender, const AgentId& p_receiver, const json& p_message,
 					  const MessageBinaryFormat& p_binary_format) :
-		m_sender(std::move(p_sender)),
-		m_receiver(std::move(p_receiver)),
+		m_references(0),
+		m_sender(p_sender),
+		m_receiver(p_receiver),
+		m_binary_format(p_binary_format),
+		m_payload() {
+	const std::vector<std::uint8_t> l_binary_message = cam::Message::to_binary(p_message, m_binary_format);
+	m_payload = MessagePayload::create(l_binary_message.data(), l_binary_message.size());
+}
+
+cam::Message::Message(const AgentId& p_sender, const AgentId& p_receiver, const uint8_t* p_message,
+					  const size_t& p_length, const MessageBinaryFormat& p_binary_format) :
+		m_references(0),
+		m_sender(p_sender),
+		m_receiver(p_receiver),
 		m_binary_format(p_binary_format),
-		m_binary_message(cam::Message::to_binary(p_message, m_binary_format)) {
+		m_payload(MessagePayload::create(p_message, p_length)) {
 }
 
-cam::Message::Message(std::string p_sender, std::string p_receiver, const uint8_t* p_message, const size_t& p_length,
+cam::Message::Message(const AgentId& p_sender, const AgentId& p_receiver, PayloadPointer p_payload,
 					  const MessageBinaryFormat& p_binary_format) :
-		m_sender(std::move(p_sender)),
-		m_receiver(std::move(p_receiver)),
-		m_binary_format(p_binary_format) {
-	if (p_message) {
-		m_binary_message = std::vector(p_message, p_message + p_length);
-	}
+		m_references(0),
+		m_sender(p_sender),
+		m_receiver(p_receiver),
+		m_binary_format(p_binary_format),
+		m_payload(std::move(p_payload)) {
+}
+
+cam::Message::Message(const AgentId& p_sender, const AgentId& p_receiver, ObjectPointer p_object) :
+		m_references(0),
+		m_sender(p_sender),
+		m_receiver(p_receiver),
+		m_binary_format(MessageBinaryFormat::MessagePack),
+		m_object(std::move(p_object)) {
 }
 
 cam::Message::Message() :
+		m_references(0),
 		m_sender(),
 		m_receiver(),
 		m_binary_format(MessageBinaryFormat::MessagePack),
-		m_binary_message() {
+		m_payload() {
 }
 
-json cam::Message::content() const {
-	return cam::Message::to_json(m_binary_message, m_binary_format);
+const json& cam::Message::content() const {
+	if (m_object) {
+		return m_object->content();
+	}
+	if (m_payload) {
+		return m_payload->content(m_binary_format);
+	}
+
+	// Empty message
+	static const json s_empty_raw_content = std::string();
+	static const json s_empty_content;
+	return m_binary_format == MessageBinaryFormat::RAW ? s_empty_raw_content : s_empty_content;
 }
 
 std::string cam::Message::to_string() const {
@@ -55,11 +134,11 @@ std::string cam::Message::to_string() const {
 }
 
 std::string cam::Message::format() const {
-	return "[" + m_sender + " -> " + m_receiver + "]: " + to_string();
+	return "[" + m_sender.to_string() + " -> " + m_receiver.to_string() + "]: " + to_string();
 }
 
 json
-cam::Message::to_json(const std::vector<std::uint8_t>& p_binary_message, const MessageBinaryFormat& p_binary_format) {
+cam::Message::to_json(const std::span<const std::uint8_t> p_binary_message, const MessageBinaryFormat& p_binary_format) {
 	switch (p_binary_format) {
 		case MessageBinaryFormat::BJData:
 			return json::from_bjdata(p_binary_message);
@@ -100,4 +179,76 @@ std::vector<std::uint8_t> cam::Message::to_binary(const json& p_message, const M
 		default:
 			return json::to_msgpack(p_message);
 	}
-}
\ No newline at end of file
+}
+
+cam::MessagePayload::MessagePayload(const size_t p_size) :
+		m_references(0),
+		m_size(p_size),
+		m_content(nullptr) {
+}
+
+cam::MessagePayload::~MessagePayload() {
+	delete m_content.load(std::memory_order_acquire);
+}
+
+const json& cam::MessagePayload::content(const MessageBinaryFormat& p_binary_format) const {
+	return get_cached_content(m_content, [this, &p_binary_format] {
+		return Message::to_json(get_data(), p_binary_format);
+	});
+}
+
+cam::MessageObject::~MessageObject() {
+	delete m_content.load(std::memory_order_acquire);
+}
+
+const json& cam::MessageObject::content() const {
+	return get_cached_content(m_content, [this] { return to_json(); });
+}
+
+cam::PayloadPointer cam::MessagePayload::create(const uint8_t* p_data, const size_t p_length) {
+	if (!p_data || p_length == 0) {
+		return nullptr;
+	}
+	// Bytes follow the header in the same block
+	void* l_storage = ::operator new(sizeof(MessagePayload) + p_length);
+	auto* l_payload = new(l_storage) MessagePayload(p_length);
+	std::memcpy(static_cast<std::uint8_t*>(l_storage) + sizeof(MessagePayload), p_data, p_length);
+	return PayloadPointer(l_payload);
+}
+
+void cam::MessagePayload::release() const noexcept {
+	if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		auto* l_payload = const_cast<MessagePayload*>(this);
+		l_payload->~MessagePayload();
+		::operator delete(l_payload);
+	}
+}
+
+void cam::Message::release() const noexcept {
+	if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		auto* l_message = const_cast<Message*>(this);
+		l_message->~Message();
+		release_storage(l_message);
+	}
+}
+
+void* cam::Message::allocate_storage() {
+	MessageStorageCache& l_cache = t_message_storage_cache;
+	if (void* l_storage = l_cache.m_head; l_storage) {
+		l_cache.m_head = *static_cast<void**>(l_storage);
+		l_cache.m_size--;
+		return l_storage;
+	}
+	return ::operator new(sizeof(Message));
+}
+
+void cam::Message::release_storage(void* p_storage) noexcept {
+	MessageStorageCache& l_cache = t_message_storage_cache;
+	if (l_cache.m_size >= MessageStorageCache::s_max_size) {
+		::operator delete(p_storage);
+		return;
+	}
+	*static_cast<void**>(p_storage) = l_cache.m_head;
+	l_cache.m_head = p_storage;
+	l_cache.m_size++;
+}
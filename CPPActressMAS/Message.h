@@ -26,6 +26,14 @@ using json = nlohmann::json;
 #include <cereal/types/string.hpp> // Serialize string
 #include <cereal/types/memory.hpp> // Serialize smart pointers
 
+#include <atomic>
+#include <span>
+#include <stdexcept>
+#include <typeinfo>
+
+#include "AgentId.h"
+#include "IntrusivePointer.hpp"
+
 /**
  * CPPActressMAS
  */
@@ -38,23 +46,244 @@ namespace cam {
 		RAW, BJData, BSON, CBOR, MessagePack, UBJSON
 	};
 
+	class Message;
+
+	class MessagePayload;
+
+	class MessageObject;
+
+	// Message pointer
+	using MessagePointer = IntrusivePointer<const Message>;
+
+	// Payload pointer
+	using PayloadPointer = IntrusivePointer<const MessagePayload>;
+
+	// Object pointer
+	using ObjectPointer = IntrusivePointer<const MessageObject>;
+
+	/**
+	 * Immutable binary content of messages. One payload is shared by every message of a
+	 * broadcast (or send by name), each receiver only gets its own small message.
+	 **/
+	class MessagePayload final {
+		friend PayloadPointer;
+
+	private:
+		/**
+		 * References held by payload pointers.
+		 **/
+		mutable std::atomic<std::uint32_t> m_references;
+
+		/**
+		 * Number of bytes, stored right after the payload.
+		 **/
+		size_t m_size;
+
+		/**
+		 * Content decoded on first access, then shared by every message of the payload.
+		 **/
+		mutable std::atomic<const json*> m_content;
+
+		/**
+		 * Payload of p_size bytes.
+		 * @param p_size Number of bytes
+		 **/
+		explicit MessagePayload(size_t p_size);
+
+	public:
+		/**
+		 * Create a payload, copying the data in the same allocation.
+		 * @param p_data The data
+		 * @param p_length The data size
+		 * @return The payload, null if empty
+		 **/
+		static PayloadPointer create(const uint8_t* p_data, size_t p_length);
+
+		/**
+		 * Delete the decoded content.
+		 **/
+		~MessagePayload();
+
+		/**
+		 * Get data.
+		 * @return data
+		 **/
+		[[nodiscard]] std::span<const std::uint8_t> get_data() const {
+			return {reinterpret_cast<const std::uint8_t*>(this) + sizeof(MessagePayload), m_size};
+		}
+
+		/**
+		 * Get data decoded once (thread-safe) and cached for every message sharing the payload.
+		 * @param p_binary_format Binary format of the data (the same for every message of the payload)
+		 * @return data JSON
+		 **/
+		[[nodiscard]] const json& content(const MessageBinaryFormat& p_binary_format) const;
+
+		// Delete copy constructor
+		MessagePayload(const MessagePayload&) = delete;
+
+		MessagePayload& operator=(MessagePayload&) = delete;
+
+	private:
+
+		/**
+		 * Take a reference.
+		 **/
+		void acquire() const noexcept {
+			m_references.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Release a reference, free the payload with the last one.
+		 **/
+		void release() const noexcept;
+	};
+
+	/**
+	 * C++ object carried by a typed message. It moves through the mailbox as is and is only
+	 * converted to JSON when the message has to leave the process (or when content() is asked).
+	 **/
+	class MessageObject {
+		friend ObjectPointer;
+
+	private:
+		/**
+		 * References held by object pointers.
+		 **/
+		mutable std::atomic<std::uint32_t> m_references;
+
+		/**
+		 * JSON conversion done on first access, then shared by every message of the object.
+		 **/
+		mutable std::atomic<const json*> m_content;
+
+	protected:
+		MessageObject() :
+				m_references(0),
+				m_content(nullptr) {}
+
+	public:
+		/**
+		 * Delete the converted content.
+		 **/
+		virtual ~MessageObject();
+
+		/**
+		 * Create an object of type T.
+		 * @param p_args T constructor arguments
+		 * @return The object
+		 **/
+		template<typename T, typename... Args>
+		static ObjectPointer create(Args&& ... p_args);
+
+		/**
+		 * Get type of the value.
+		 * @return Type
+		 **/
+		[[nodiscard]] virtual const std::type_info& get_type() const = 0;
+
+		/**
+		 * Convert the value to JSON.
+		 * @return JSON value, throw if the type has no JSON conversion
+		 **/
+		[[nodiscard]] virtual json to_json() const = 0;
+
+		/**
+		 * Get the value converted to JSON once (thread-safe) and cached for the next calls.
+		 * @return JSON value, throw if the type has no JSON conversion
+		 **/
+		[[nodiscard]] const json& content() const;
+
+		// Delete copy constructor
+		MessageObject(const MessageObject&) = delete;
+
+		MessageObject& operator=(MessageObject&) = delete;
+
+	private:
+
+		/**
+		 * Take a reference.
+		 **/
+		void acquire() const noexcept {
+			m_references.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Release a reference, delete the object with the last one.
+		 **/
+		void release() const noexcept {
+			if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete this;
+			}
+		}
+	};
+
+	/**
+	 * Object of type T carried by a typed message.
+	 **/
+	template<typename T>
+	class TypedMessageObject final : public MessageObject {
+	private:
+		/**
+		 * The value.
+		 **/
+		T m_value;
+
+	public:
+		/**
+		 * Build the value in place.
+		 * @param p_args T constructor arguments
+		 **/
+		template<typename... Args>
+		explicit TypedMessageObject(Args&& ... p_args) :
+				MessageObject(),
+				m_value(std::forward<Args>(p_args)...) {}
+
+		/**
+		 * Get value.
+		 * @return value
+		 **/
+		[[nodiscard]] const T& get_value() const { return m_value; }
+
+		[[nodiscard]] const std::type_info& get_type() const override { return typeid(T); }
+
+		[[nodiscard]] json to_json() const override {
+			if constexpr (std::is_constructible_v<json, const T&>) {
+				return json(m_value);
+			} else {
+				throw std::logic_error(std::string("no JSON conversion for ") + typeid(T).name());
+			}
+		}
+	};
+
+	template<typename T, typename... Args>
+	ObjectPointer MessageObject::create(Args&& ... p_args) {
+		return ObjectPointer(new TypedMessageObject<T>(std::forward<Args>(p_args)...));
+	}
+
 	/**
 	 * A message that the agents use to communicate. In an agent-based system, the
 	 * communication between the agents is exclusively performed by exchanging
 	 * messages.
 	 **/
 	class Message final {
+		friend MessagePointer;
 
 	protected:
+		/**
+		 * References held by message pointers.
+		 **/
+		mutable std::atomic<std::uint32_t> m_references;
+
 		/**
 		 * Sender.
 		 **/
-		std::string m_sender;
+		AgentId m_sender;
 
 		/**
 		 * Receiver.
 		 **/
-		std::string m_receiver;
+		AgentId m_receiver;
 
 		/**
 		 * Binary format.
@@ -62,9 +291,14 @@ namespace cam {
 		MessageBinaryFormat m_binary_format;
 
 		/**
-		 * Raw message.
+		 * Raw message, shared with the other receivers.
+		 **/
+		PayloadPointer m_payload;
+
+		/**
+		 * Typed message, null for raw messages.
 		 **/
-		std::vector<std::uint8_t> m_binary_message;
+		ObjectPointer m_object;
 
 	public:
 		/**
@@ -74,36 +308,73 @@ namespace cam {
 		 * @param p_message Message.
 		 * @param p_binary_format Binary format used.
 		 **/
-		Message(std::string p_sender, std::string p_receiver, const json& p_message,
+		Message(const AgentId& p_sender, const AgentId& p_receiver, const json& p_message,
 				const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::MessagePack);
 
-		Message(std::string p_sender, std::string p_receiver, const uint8_t* p_message, const size_t& p_length,
+		Message(const AgentId& p_sender, const AgentId& p_receiver, const uint8_t* p_message, const size_t& p_length,
 				const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::RAW);
 
+		Message(const AgentId& p_sender, const AgentId& p_receiver, PayloadPointer p_payload,
+				const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::RAW);
+
+		Message(const AgentId& p_sender, const AgentId& p_receiver, ObjectPointer p_object);
+
 		Message();
 
-		/**
-		 * Nothing to delete.
-		 **/
 		/*virtual*/ ~Message() = default;
 
 		/**
 		 * Get sender.
 		 * @return Sender.
 		 **/
-		[[nodiscard]] const std::string& get_sender() const { return m_sender; }
+		[[nodiscard]] const AgentId& get_sender() const { return m_sender; }
 
 		/**
 		 * Get receiver.
 		 * @return Receiver.
 		 **/
-		[[nodiscard]] const std::string& get_receiver() const { return m_receiver; }
+		[[nodiscard]] const AgentId& get_receiver() const { return m_receiver; }
 
 		/**
 		 * Get binary message.
-		 * @return binary message JSON
+		 * @return binary message JSON, empty for typed messages
+		 **/
+		[[nodiscard]] std::span<const std::uint8_t> get_binary_message() const {
+			return m_payload ? m_payload->get_data() : std::span<const std::uint8_t>();
+		}
+
+		/**
+		 * Get payload.
+		 * @return payload shared by all receivers, null if empty
+		 **/
+		[[nodiscard]] const PayloadPointer& get_payload() const { return m_payload; }
+
+		/**
+		 * Get object.
+		 * @return object of a typed message, null for raw messages
+		 **/
+		[[nodiscard]] const ObjectPointer& get_object() const { return m_object; }
+
+		/**
+		 * True if the message carries an object of type T.
+		 * @return True if typed as T
+		 **/
+		template<typename T>
+		[[nodiscard]] bool is() const {
+			return m_object && m_object->get_type() == typeid(T);
+		}
+
+		/**
+		 * Get the object of a typed message, without any decoding.
+		 * @return The object, throw std::bad_cast if the message does not carry a T
 		 **/
-		[[nodiscard]] const std::vector<std::uint8_t>& get_binary_message() const { return m_binary_message; }
+		template<typename T>
+		[[nodiscard]] const T& as() const {
+			if (!is<T>()) {
+				throw std::bad_cast();
+			}
+			return static_cast<const TypedMessageObject<T>&>(*m_object).get_value();
+		}
 
 		/**
 		 * Get binary message.
@@ -112,10 +383,10 @@ namespace cam {
 		[[nodiscard]] const MessageBinaryFormat& get_binary_format() const { return m_binary_format; }
 
 		/**
-		 * Get message.
-		 * @return message JSON
+		 * Get message, decoded once (thread-safe) by its payload or object for every receiver.
+		 * @return message JSON (converted from the object for typed messages)
 		 **/
-		[[nodiscard]] json content() const;
+		[[nodiscard]] const json& content() const;
 
 		/**
 		 * Format message to string.
@@ -130,8 +401,41 @@ namespace cam {
 		[[nodiscard]] /*virtual*/ std::string format() const;
 
 		template<class Archive>
-		void serialize(Archive& p_archive) {
-			p_archive(m_sender, m_receiver, m_binary_message, m_binary_format);
+		void save(Archive& p_archive) const {
+			// Typed messages are encoded only here
+			if (m_object) {
+				p_archive(m_sender, m_receiver, to_binary(m_object->content(), m_binary_format), m_binary_format);
+				return;
+			}
+			const auto& l_binary_message = get_binary_message();
+			p_archive(m_sender, m_receiver, std::vector(l_binary_message.begin(), l_binary_message.end()),
+					  m_binary_format);
+		}
+
+		template<class Archive>
+		void load(Archive& p_archive) {
+			std::vector<std::uint8_t> l_binary_message;
+			p_archive(m_sender, m_receiver, l_binary_message, m_binary_format);
+			m_payload = MessagePayload::create(l_binary_message.data(), l_binary_message.size());
+			m_object.reset();
+		}
+
+		/**
+		 * Create a message from the message pool. The memory of a message is given back to a free
+		 * list local to the thread releasing its last reference, so sending does not go through the
+		 * general-purpose allocator once the free lists are warm.
+		 * @param p_args Message constructor arguments
+		 * @return The message
+		 **/
+		template<typename... Args>
+		static MessagePointer create(Args&& ... p_args) {
+			void* l_storage = allocate_storage();
+			try {
+				return MessagePointer(new(l_storage) Message(std::forward<Args>(p_args)...));
+			} catch (...) {
+				release_storage(l_storage);
+				throw;
+			}
 		}
 
 		/**
@@ -143,15 +447,64 @@ namespace cam {
 		static std::vector<std::uint8_t>
 		to_binary(const json& p_message, const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::MessagePack);
 
-		static json to_json(const std::vector<std::uint8_t>& p_message,
+		static json to_json(std::span<const std::uint8_t> p_message,
 							const MessageBinaryFormat& p_binary_format = MessageBinaryFormat::MessagePack);
 
 		// Delete copy constructor
 		Message(const Message&) = delete;
 
 		Message& operator=(Message&) = delete;
+
+	private:
+
+		/**
+		 * Take a reference.
+		 **/
+		void acquire() const noexcept {
+			m_references.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Release a reference, destroy the message with the last one.
+		 **/
+		void release() const noexcept;
+
+		/**
+		 * Message memory from/to the free list of the calling thread.
+		 **/
+		static void* allocate_storage();
+
+		static void release_storage(void* p_storage) noexcept;
 	};
 
-	// Message pointer
-	using MessagePointer = std::shared_ptr<const Message>;
+	/**
+	 * Serialize message pointer
+	 * @param p_archive archive to store message
+	 * @param p_message the message
+	 */
+	template<class Archive>
+	void save(Archive& p_archive, const MessagePointer& p_message) {
+		const bool l_is_valid = static_cast<bool>(p_message);
+		p_archive(l_is_valid);
+		if (l_is_valid) {
+			p_archive(*p_message);
+		}
+	}
+
+	/**
+	 * Deserialize message pointer
+	 * @param p_archive archive to restore message
+	 * @param p_message the message
+	 */
+	template<class Archive>
+	void load(Archive& p_archive, MessagePointer& p_message) {
+		bool l_is_valid;
+		p_archive(l_is_valid);
+		p_message.reset();
+		if (l_is_valid) {
+			MessagePointer l_message = Message::create();
+			p_archive(const_cast<Message&>(*l_message));
+			p_message = std::move(l_message);
+		}
+	}
 } // namespace cam
@@ -0,0 +1,131 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "NameIndex.h"
+
+#include <algorithm>
+
+void cam::NameIndex::insert(const std::string& p_name, const AgentId& p_id, const AgentHandle& p_handle) {
+	if (const auto& l_it = m_name_indexes.find(p_name); l_it != m_name_indexes.end()) {
+		m_names[l_it->second].m_agents.push_back(p_id);
+		m_names[l_it->second].m_handles.push_back(p_handle);
+		return;
+	}
+
+	// New name
+	std::uint32_t l_name_index;
+	if (m_free_names.empty()) {
+		l_name_index = static_cast<std::uint32_t>(m_names.size());
+		m_names.emplace_back();
+	} else {
+		l_name_index = m_free_names.back();
+		m_free_names.pop_back();
+	}
+	NameEntry& l_entry = m_names[l_name_index];
+	l_entry.m_name = p_name;
+	l_entry.m_agents.push_back(p_id);
+	l_entry.m_handles.push_back(p_handle);
+	m_name_indexes.emplace(p_name, l_name_index);
+	for (const std::uint32_t l_trigram: get_trigrams(p_name)) {
+		m_trigrams[l_trigram].push_back(l_name_index);
+	}
+}
+
+void cam::NameIndex::mark(const std::string& p_name) {
+	const auto& l_it = m_name_indexes.find(p_name);
+	if (l_it == m_name_indexes.end() || m_names[l_it->second].m_is_marked) {
+		return;
+	}
+	m_names[l_it->second].m_is_marked = true;
+	m_marked_names.push_back(l_it->second);
+}
+
+void cam::NameIndex::release(const std::uint32_t p_name_index) {
+	NameEntry& l_entry = m_names[p_name_index];
+	for (const std::uint32_t l_trigram: get_trigrams(l_entry.m_name)) {
+		const auto& l_trigram_it = m_trigrams.find(l_trigram);
+		std::vector<std::uint32_t>& l_names = l_trigram_it->second;
+		*std::ranges::find(l_names, p_name_index) = l_names.back();
+		l_names.pop_back();
+		if (l_names.empty()) {
+			m_trigrams.erase(l_trigram_it);
+		}
+	}
+	m_name_indexes.erase(l_entry.m_name);
+	l_entry.m_name.clear();
+	m_free_names.push_back(p_name_index);
+}
+
+std::span<const cam::AgentId> cam::NameIndex::find(const std::string& p_name) const {
+	const auto& l_it = m_name_indexes.find(p_name);
+	if (l_it == m_name_indexes.end()) {
+		return {};
+	}
+	return m_names[l_it->second].m_agents;
+}
+
+std::span<const cam::AgentHandle> cam::NameIndex::find_handles(const std::string& p_name) const {
+	const auto& l_it = m_name_indexes.find(p_name);
+	if (l_it == m_name_indexes.end()) {
+		return {};
+	}
+	return m_names[l_it->second].m_handles;
+}
+
+std::vector<std::uint32_t> cam::NameIndex::get_candidates(const std::string_view p_fragment) const {
+	const std::vector<std::uint32_t>& l_trigrams = get_trigrams(p_fragment);
+
+	// Too short to be indexed: every name is a candidate
+	if (l_trigrams.empty()) {
+		std::vector<std::uint32_t> l_candidates;
+		l_candidates.reserve(m_name_indexes.size());
+		for (const auto& [l_name, l_name_index]: m_name_indexes) {
+			l_candidates.push_back(l_name_index);
+		}
+		return l_candidates;
+	}
+
+	// A matching name holds every trigram of the fragment, check the names of the rarest one
+	const std::vector<std::uint32_t>* l_rarest = nullptr;
+	for (const std::uint32_t l_trigram: l_trigrams) {
+		const auto& l_it = m_trigrams.find(l_trigram);
+		if (l_it == m_trigrams.end()) {
+			return {};
+		}
+		if (!l_rarest || l_it->second.size() < l_rarest->size()) {
+			l_rarest = &l_it->second;
+		}
+	}
+	return *l_rarest;
+}
+
+std::vector<std::uint32_t> cam::NameIndex::get_trigrams(const std::string_view p_string) {
+	std::vector<std::uint32_t> l_trigrams;
+	if (p_string.size() < 3) {
+		return l_trigrams;
+	}
+	l_trigrams.reserve(p_string.size() - 2);
+	for (size_t l_index = 0; l_index + 2 < p_string.size(); l_index++) {
+		l_trigrams.push_back(static_cast<std::uint32_t>(static_cast<unsigned char>(p_string[l_index])) << 16 |
+							 static_cast<std::uint32_t>(static_cast<unsigned char>(p_string[l_index + 1])) << 8 |
+							 static_cast<std::uint32_t>(static_cast<unsigned char>(p_string[l_index + 2])));
+	}
+	std::ranges::sort(l_trigrams);
+	l_trigrams.erase(std::unique(l_trigrams.begin(), l_trigrams.end()), l_trigrams.end());
+	return l_trigrams;
+}
@@ -0,0 +1,174 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "AgentHandle.h"
+#include "AgentId.h"
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Index of the agents by name.
+	 * Exact names are found with one hash lookup. Fragments are found with a trigram index:
+	 * only the names holding the rarest trigram of the fragment are checked, so the cost depends
+	 * on the number of matching names instead of the number of agents.
+	 **/
+	class NameIndex final {
+		/**
+		 * Distinct name and its agents (ids and resolved handles), in insertion order
+		 **/
+		struct NameEntry {
+			std::string m_name;
+			std::vector<AgentId> m_agents;
+			std::vector<AgentHandle> m_handles;
+			bool m_is_marked = false;
+		};
+
+	protected:
+		/**
+		 * Names: name, name index in m_names
+		 **/
+		std::unordered_map<std::string, std::uint32_t> m_name_indexes;
+
+		/**
+		 * Distinct names
+		 **/
+		std::vector<NameEntry> m_names;
+
+		/**
+		 * Released entries of m_names
+		 **/
+		std::vector<std::uint32_t> m_free_names;
+
+		/**
+		 * Trigrams: trigram, names containing it
+		 **/
+		std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> m_trigrams;
+
+		/**
+		 * Names holding removed agents, until compact
+		 **/
+		std::vector<std::uint32_t> m_marked_names;
+
+	public:
+		/**
+		 * Add an agent
+		 * @param p_name The agent name
+		 * @param p_id The agent id
+		 * @param p_handle The agent handle
+		 **/
+		void insert(const std::string& p_name, const AgentId& p_id, const AgentHandle& p_handle);
+
+		/**
+		 * Mark the name of a removed agent, the agent is removed by the next compact
+		 * @param p_name The agent name
+		 **/
+		void mark(const std::string& p_name);
+
+		/**
+		 * Remove the agents of the marked names, each name is compacted in a single pass
+		 * however many of its agents are removed
+		 * @param p_is_removed Predicate called with the handle of each agent of the marked names
+		 **/
+		template<typename F>
+		void compact(F&& p_is_removed) {
+			for (const std::uint32_t l_name_index: m_marked_names) {
+				NameEntry& l_entry = m_names[l_name_index];
+				l_entry.m_is_marked = false;
+				size_t l_kept = 0;
+				for (size_t l_index = 0; l_index < l_entry.m_handles.size(); l_index++) {
+					if (!p_is_removed(l_entry.m_handles[l_index])) {
+						l_entry.m_agents[l_kept] = l_entry.m_agents[l_index];
+						l_entry.m_handles[l_kept] = l_entry.m_handles[l_index];
+						l_kept++;
+					}
+				}
+				l_entry.m_agents.resize(l_kept);
+				l_entry.m_handles.resize(l_kept);
+				if (l_kept == 0) {
+					release(l_name_index);
+				}
+			}
+			m_marked_names.clear();
+		}
+
+		/**
+		 * Agents named p_name
+		 * @param p_name The name
+		 * @return The agents, in insertion order
+		 **/
+		[[nodiscard]] std::span<const AgentId> find(const std::string& p_name) const;
+
+		/**
+		 * Handles of the agents named p_name, only changed when an agent with this name is added or removed
+		 * @param p_name The name
+		 * @return The handles, in insertion order
+		 **/
+		[[nodiscard]] std::span<const AgentHandle> find_handles(const std::string& p_name) const;
+
+		/**
+		 * Call p_function(agents, handles) for each name containing p_fragment
+		 * @param p_fragment The fragment
+		 * @param p_function Function called with the agents and handles of each matching name
+		 **/
+		template<typename F>
+		void for_each_fragment(const std::string_view p_fragment, F&& p_function) const {
+			for (const std::uint32_t l_name_index: get_candidates(p_fragment)) {
+				const NameEntry& l_entry = m_names[l_name_index];
+				if (!l_entry.m_agents.empty() && l_entry.m_name.find(p_fragment) != std::string::npos) {
+					p_function(std::span<const AgentId>(l_entry.m_agents),
+							   std::span<const AgentHandle>(l_entry.m_handles));
+				}
+			}
+		}
+
+	private:
+
+		/**
+		 * Remove a name without agents
+		 * @param p_name_index The name index in m_names
+		 **/
+		void release(std::uint32_t p_name_index);
+
+		/**
+		 * Names that may contain p_fragment
+		 * @param p_fragment The fragment
+		 * @return Name indexes to check
+		 **/
+		[[nodiscard]] std::vector<std::uint32_t> get_candidates(std::string_view p_fragment) const;
+
+		/**
+		 * Distinct trigrams of p_string
+		 * @param p_string The string
+		 * @return The trigrams, empty if shorter than 3 characters
+		 **/
+		static std::vector<std::uint32_t> get_trigrams(std::string_view p_string);
+	};
+
+} // namespace cam
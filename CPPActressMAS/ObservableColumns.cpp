@@ -0,0 +1,61 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "ObservableColumns.h"
+
+cam::ObservableKey cam::ObservableColumns::intern(const std::string& p_name) {
+	const auto& [l_it, l_inserted] = m_keys.try_emplace(p_name, static_cast<ObservableKey>(m_names.size()));
+	if (l_inserted) {
+		m_names.push_back(p_name);
+		m_values.emplace_back(m_slot_count, s_missing);
+		m_published_values.emplace_back(m_slot_count, s_missing);
+	}
+	return l_it->second;
+}
+
+std::optional<cam::ObservableKey> cam::ObservableColumns::find(const std::string& p_name) const {
+	const auto& l_it = m_keys.find(p_name);
+	if (l_it == m_keys.end()) {
+		return {};
+	}
+	return l_it->second;
+}
+
+void cam::ObservableColumns::resize(const size_t p_slot_count) {
+	if (p_slot_count <= m_slot_count) {
+		return;
+	}
+	m_slot_count = p_slot_count;
+	for (size_t l_key = 0; l_key < m_names.size(); l_key++) {
+		m_values[l_key].resize(m_slot_count, s_missing);
+		m_published_values[l_key].resize(m_slot_count, s_missing);
+	}
+}
+
+void cam::ObservableColumns::reset(const std::uint32_t p_slot) {
+	for (size_t l_key = 0; l_key < m_names.size(); l_key++) {
+		m_values[l_key][p_slot] = s_missing;
+		m_published_values[l_key][p_slot] = s_missing;
+	}
+}
+
+void cam::ObservableColumns::publish() {
+	for (size_t l_key = 0; l_key < m_names.size(); l_key++) {
+		std::copy(m_values[l_key].begin(), m_values[l_key].end(), m_published_values[l_key].begin());
+	}
+}
@@ -0,0 +1,192 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Interned name of a typed observable
+	 **/
+	using ObservableKey = std::uint32_t;
+
+	/**
+	 * Typed observables: numeric values stored in one column per key, indexed by agent slot.
+	 * A key is a small integer interned once by name, reading or writing a value is an array access.
+	 * Columns are double-buffered: agents write the current column, perception reads the published
+	 * one, copied from the current column at the start of each turn. A missing value is NaN.
+	 **/
+	class ObservableColumns final {
+	protected:
+		/**
+		 * Keys: name, key
+		 **/
+		std::unordered_map<std::string, ObservableKey> m_keys;
+
+		/**
+		 * Names, by key
+		 **/
+		std::vector<std::string> m_names;
+
+		/**
+		 * Values written during the turn, by key then slot
+		 **/
+		std::vector<std::vector<double>> m_values;
+
+		/**
+		 * Values at the start of the turn, by key then slot
+		 **/
+		std::vector<std::vector<double>> m_published_values;
+
+		/**
+		 * Number of slots
+		 **/
+		size_t m_slot_count;
+
+	public:
+		/**
+		 * No key, no slot
+		 **/
+		ObservableColumns() :
+				m_slot_count(0) {}
+
+		/**
+		 * Missing value
+		 **/
+		static constexpr double s_missing = std::numeric_limits<double>::quiet_NaN();
+
+		/**
+		 * Get or create the key of a name. Keys must be created before the agents run, not during a turn.
+		 * @param p_name The name
+		 * @return The key
+		 **/
+		ObservableKey intern(const std::string& p_name);
+
+		/**
+		 * Get the key of a name
+		 * @param p_name The name
+		 * @return The key, empty if the name is not interned
+		 **/
+		[[nodiscard]] std::optional<ObservableKey> find(const std::string& p_name) const;
+
+		/**
+		 * Get the name of a key
+		 * @param p_key The key
+		 * @return The name
+		 **/
+		[[nodiscard]] const std::string& get_name(const ObservableKey p_key) const { return m_names.at(p_key); }
+
+		/**
+		 * Number of keys
+		 * @return Number of keys
+		 **/
+		[[nodiscard]] size_t size() const { return m_names.size(); }
+
+		/**
+		 * Number of slots
+		 * @return Number of slots
+		 **/
+		[[nodiscard]] size_t get_slot_count() const { return m_slot_count; }
+
+		/**
+		 * Grow the columns, new slots have missing values
+		 * @param p_slot_count Number of slots
+		 **/
+		void resize(size_t p_slot_count);
+
+		/**
+		 * Clear the values of a released slot
+		 * @param p_slot The slot
+		 **/
+		void reset(std::uint32_t p_slot);
+
+		/**
+		 * Copy the current values to the published ones (start of turn)
+		 **/
+		void publish();
+
+		/**
+		 * Set the current value of a slot
+		 * @param p_key The key
+		 * @param p_slot The slot
+		 * @param p_value The value
+		 **/
+		void set(const ObservableKey p_key, const std::uint32_t p_slot, const double p_value) {
+			check(p_key, p_slot);
+			m_values[p_key][p_slot] = p_value;
+		}
+
+		/**
+		 * Get the current value of a slot
+		 * @param p_key The key
+		 * @param p_slot The slot
+		 * @return The value, NaN if missing
+		 **/
+		[[nodiscard]] double get(const ObservableKey p_key, const std::uint32_t p_slot) const {
+			check(p_key, p_slot);
+			return m_values[p_key][p_slot];
+		}
+
+		/**
+		 * Get the published value of a slot
+		 * @param p_key The key
+		 * @param p_slot The slot
+		 * @return The value, NaN if missing
+		 **/
+		[[nodiscard]] double get_published(const ObservableKey p_key, const std::uint32_t p_slot) const {
+			check(p_key, p_slot);
+			return m_published_values[p_key][p_slot];
+		}
+
+		/**
+		 * Get the published column of a key
+		 * @param p_key The key
+		 * @return The values, by slot
+		 **/
+		[[nodiscard]] std::span<const double> get_published_column(const ObservableKey p_key) const {
+			return m_published_values.at(p_key);
+		}
+
+	private:
+
+		/**
+		 * Throw if the key or the slot does not exist
+		 * @param p_key The key
+		 * @param p_slot The slot
+		 **/
+		void check(const ObservableKey p_key, const std::uint32_t p_slot) const {
+			if (p_key >= m_names.size() || p_slot >= m_slot_count) {
+				throw std::out_of_range("Unknown observable key or agent slot");
+			}
+		}
+	};
+
+} // namespace cam
@@ -0,0 +1,42 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Represents the observable properties of an agent. They depend on the set of
+	 * Observables properties of an agent and on the PerceptionFilter function of an
+	 * agent who wants to observe other agents.
+	 **/
+	using Observables = std::unordered_map<std::string, json>;
+	using ObservablesPointer = std::shared_ptr<const Observables>;
+
+} // namespace cam
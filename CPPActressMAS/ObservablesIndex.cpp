@@ -0,0 +1,138 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "ObservablesIndex.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void cam::ObservablesIndex::clear() {
+	m_equal_indexes.clear();
+	m_range_indexes.clear();
+	m_size = 0;
+}
+
+void cam::ObservablesIndex::add_keys(const PerceptionQuery& p_query) {
+	for (const PerceptionQuery::Predicate& l_predicate: p_query.get_predicates()) {
+		if (l_predicate.m_is_range) {
+			m_range_indexes.try_emplace(l_predicate.m_key);
+		} else {
+			m_equal_indexes.try_emplace(l_predicate.m_key);
+		}
+	}
+}
+
+void cam::ObservablesIndex::insert(const std::uint32_t p_index,
+								   const std::unordered_map<std::string, json>& p_observables) {
+	m_size = p_index + 1;
+	for (auto& [l_key, l_index]: m_equal_indexes) {
+		if (const auto& l_it = p_observables.find(l_key); l_it != p_observables.end()) {
+			l_index[PerceptionQuery::normalize(l_it->second)].push_back(p_index);
+		}
+	}
+	for (auto& [l_key, l_index]: m_range_indexes) {
+		// NaN never matches a range and would break the ordering of the index
+		if (const auto& l_it = p_observables.find(l_key); l_it != p_observables.end() && l_it->second.is_number()) {
+			if (const double l_value = l_it->second.get<double>(); !std::isnan(l_value)) {
+				l_index.emplace_back(l_value, p_index);
+			}
+		}
+	}
+}
+
+void cam::ObservablesIndex::build() {
+	for (auto& [l_key, l_index]: m_range_indexes) {
+		std::ranges::sort(l_index);
+	}
+}
+
+bool cam::ObservablesIndex::select(const PerceptionQuery& p_query, std::vector<std::uint32_t>& p_candidates,
+								  size_t& p_predicate) const {
+	static const std::vector<std::uint32_t> s_no_agents;
+
+	// Most selective predicate
+	const std::vector<std::uint32_t>* l_equal_candidates = nullptr;
+	const std::pair<double, std::uint32_t>* l_range_begin = nullptr;
+	const std::pair<double, std::uint32_t>* l_range_end = nullptr;
+	size_t l_best_size = 0;
+	bool l_found = false;
+	const std::vector<PerceptionQuery::Predicate>& l_predicates = p_query.get_predicates();
+	for (size_t l_position = 0; l_position < l_predicates.size(); l_position++) {
+		const PerceptionQuery::Predicate& l_predicate = l_predicates[l_position];
+		if (l_predicate.m_is_range) {
+			const auto& l_it = m_range_indexes.find(l_predicate.m_key);
+			if (l_it == m_range_indexes.end()) {
+				continue;
+			}
+			const auto& l_index = l_it->second;
+			const auto l_begin = std::ranges::lower_bound(l_index, l_predicate.m_min, {},
+														  &std::pair<double, std::uint32_t>::first);
+			const auto l_end = std::ranges::upper_bound(l_begin, l_index.end(), l_predicate.m_max, {},
+														&std::pair<double, std::uint32_t>::first);
+			const auto l_size = static_cast<size_t>(std::max<std::ptrdiff_t>(0, l_end - l_begin));
+			if (!l_found || l_size < l_best_size) {
+				l_found = true;
+				l_best_size = l_size;
+				p_predicate = l_position;
+				l_equal_candidates = nullptr;
+				l_range_begin = l_index.data() + (l_begin - l_index.begin());
+				l_range_end = l_range_begin + l_size;
+			}
+		} else {
+			const auto& l_it = m_equal_indexes.find(l_predicate.m_key);
+			if (l_it == m_equal_indexes.end()) {
+				continue;
+			}
+			const auto& l_value_it = l_it->second.find(l_predicate.m_value);
+			const auto& l_agents = l_value_it == l_it->second.end() ? s_no_agents : l_value_it->second;
+			if (!l_found || l_agents.size() < l_best_size) {
+				l_found = true;
+				l_best_size = l_agents.size();
+				p_predicate = l_position;
+				l_equal_candidates = &l_agents;
+			}
+		}
+	}
+	if (!l_found) {
+		return false;
+	}
+
+	p_candidates.clear();
+	if (l_equal_candidates) {
+		p_candidates.assign(l_equal_candidates->begin(), l_equal_candidates->end());
+	} else if (l_best_size <= s_max_sorted_range) {
+		for (auto l_it = l_range_begin; l_it != l_range_end; ++l_it) {
+			p_candidates.push_back(l_it->second);
+		}
+		std::ranges::sort(p_candidates);
+	} else {
+		// Ranges are sorted by value: mark the positions, then read them in order
+		std::vector<std::uint64_t> l_marks((m_size + 63) / 64);
+		for (auto l_it = l_range_begin; l_it != l_range_end; ++l_it) {
+			l_marks[l_it->second / 64] |= std::uint64_t(1) << (l_it->second % 64);
+		}
+		p_candidates.reserve(l_best_size);
+		for (size_t l_word = 0; l_word < l_marks.size(); l_word++) {
+			for (std::uint64_t l_bits = l_marks[l_word]; l_bits; l_bits &= l_bits - 1) {
+				p_candidates.push_back(static_cast<std::uint32_t>(l_word * 64 + std::countr_zero(l_bits)));
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,95 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "PerceptionQuery.h"
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Per-key indexes over the observables snapshot of a turn, for the keys used by perception queries:
+	 * a hash index (value -> agents) for equality predicates and a sorted index for range predicates.
+	 * Agents are designated by their position in the snapshot.
+	 **/
+	class ObservablesIndex final {
+	protected:
+		/**
+		 * Equality indexes: key, value, agents (ascending)
+		 **/
+		std::unordered_map<std::string, std::unordered_map<json, std::vector<std::uint32_t>>> m_equal_indexes;
+
+		/**
+		 * Range indexes: key, (value, agent) sorted by value
+		 **/
+		std::unordered_map<std::string, std::vector<std::pair<double, std::uint32_t>>> m_range_indexes;
+
+		/**
+		 * Number of positions in the snapshot (last inserted position + 1)
+		 **/
+		std::uint32_t m_size = 0;
+
+		/**
+		 * Above this number of candidates, a range is put in ascending order with a bitmap instead of a sort
+		 **/
+		static constexpr size_t s_max_sorted_range = 64;
+
+	public:
+		/**
+		 * Drop indexes and keys
+		 **/
+		void clear();
+
+		/**
+		 * Index the keys used by a query
+		 * @param p_query The query
+		 **/
+		void add_keys(const PerceptionQuery& p_query);
+
+		/**
+		 * Index an agent, in ascending order of p_index
+		 * @param p_index Position of the agent in the snapshot
+		 * @param p_observables Its observables
+		 **/
+		void insert(std::uint32_t p_index, const std::unordered_map<std::string, json>& p_observables);
+
+		/**
+		 * Sort the range indexes, once every agent is inserted
+		 **/
+		void build();
+
+		/**
+		 * Agents that may match p_query, from the index of its most selective predicate
+		 * @param p_query The query
+		 * @param p_candidates Output, ascending positions in the snapshot
+		 * @param p_predicate Output, position of the predicate matched by every candidate
+		 * @return False if no predicate is indexed (every agent is a candidate)
+		 **/
+		bool select(const PerceptionQuery& p_query, std::vector<std::uint32_t>& p_candidates,
+					size_t& p_predicate) const;
+	};
+
+} // namespace cam
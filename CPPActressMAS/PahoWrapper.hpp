@@ -21,6 +21,7 @@
 #include <mqtt/async_client.h>
 
 #include <chrono>
+#include <future>
 
 #include <uuid/UUID.hpp>
 
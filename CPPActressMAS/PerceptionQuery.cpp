@@ -0,0 +1,69 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "PerceptionQuery.h"
+
+cam::PerceptionQuery& cam::PerceptionQuery::where_equal(const std::string& p_key, const json& p_value) {
+	m_predicates.push_back({p_key, false, normalize(p_value), 0, 0});
+	return *this;
+}
+
+cam::PerceptionQuery& cam::PerceptionQuery::where_in_range(const std::string& p_key, const double p_min,
+														   const double p_max) {
+	m_predicates.push_back({p_key, true, json(), p_min, p_max});
+	return *this;
+}
+
+bool cam::PerceptionQuery::matches(const std::unordered_map<std::string, json>& p_observables) const {
+	for (const Predicate& l_predicate: m_predicates) {
+		if (!matches(l_predicate, p_observables)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool cam::PerceptionQuery::matches(const std::unordered_map<std::string, json>& p_observables,
+								   const size_t p_skipped_predicate) const {
+	for (size_t l_index = 0; l_index < m_predicates.size(); l_index++) {
+		if (l_index != p_skipped_predicate && !matches(m_predicates[l_index], p_observables)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool cam::PerceptionQuery::matches(const Predicate& p_predicate,
+								   const std::unordered_map<std::string, json>& p_observables) {
+	const auto& l_it = p_observables.find(p_predicate.m_key);
+	if (l_it == p_observables.end()) {
+		return false;
+	}
+	if (!p_predicate.m_is_range) {
+		return l_it->second == p_predicate.m_value;
+	}
+	if (!l_it->second.is_number()) {
+		return false;
+	}
+	const auto l_value = l_it->second.get<double>();
+	return l_value >= p_predicate.m_min && l_value <= p_predicate.m_max;
+}
+
+json cam::PerceptionQuery::normalize(const json& p_value) {
+	return p_value.is_number() ? json(p_value.get<double>()) : p_value;
+}
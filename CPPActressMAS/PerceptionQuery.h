@@ -0,0 +1,164 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Declarative perception: a conjunction of predicates on the observables of the other agents.
+	 * The environment answers it from per-key indexes instead of calling perception_filter on every agent.
+	 **/
+	class PerceptionQuery final {
+	public:
+		/**
+		 * Predicate on one key: value == m_value, or m_min <= value <= m_max for a range
+		 **/
+		struct Predicate {
+			std::string m_key;
+			bool m_is_range;
+			json m_value;
+			double m_min;
+			double m_max;
+
+			bool operator==(const Predicate&) const = default;
+		};
+
+	protected:
+		/**
+		 * Predicates, all must match
+		 **/
+		std::vector<Predicate> m_predicates;
+
+	public:
+		/**
+		 * Observed agents must have p_key equal to p_value
+		 * @param p_key The observable key
+		 * @param p_value The value
+		 * @return this query
+		 **/
+		PerceptionQuery& where_equal(const std::string& p_key, const json& p_value);
+
+		/**
+		 * Observed agents must have p_key in [p_min, p_max]
+		 * @param p_key The observable key
+		 * @param p_min The min value
+		 * @param p_max The max value
+		 * @return this query
+		 **/
+		PerceptionQuery& where_in_range(const std::string& p_key, double p_min, double p_max);
+
+		/**
+		 * Remove all predicates
+		 * @return this query
+		 **/
+		PerceptionQuery& clear() {
+			m_predicates.clear();
+			return *this;
+		}
+
+		/**
+		 * True if there is no predicate (the perception filter is used)
+		 * @return True if empty
+		 **/
+		[[nodiscard]] bool empty() const { return m_predicates.empty(); }
+
+		bool operator==(const PerceptionQuery&) const = default;
+
+		/**
+		 * Get predicates
+		 * @return The predicates
+		 **/
+		[[nodiscard]] const std::vector<Predicate>& get_predicates() const { return m_predicates; }
+
+		/**
+		 * Evaluate the query
+		 * @param p_observables Observables of the observed agent
+		 * @return True if every predicate matches
+		 **/
+		[[nodiscard]] bool matches(const std::unordered_map<std::string, json>& p_observables) const;
+
+		/**
+		 * Evaluate the query without one predicate (already checked by an index)
+		 * @param p_observables Observables of the observed agent
+		 * @param p_skipped_predicate Position of the predicate not evaluated
+		 * @return True if every other predicate matches
+		 **/
+		[[nodiscard]] bool matches(const std::unordered_map<std::string, json>& p_observables,
+								   size_t p_skipped_predicate) const;
+
+		/**
+		 * Evaluate one predicate
+		 * @param p_predicate The predicate
+		 * @param p_observables Observables of the observed agent
+		 * @return True if it matches
+		 **/
+		static bool matches(const Predicate& p_predicate, const std::unordered_map<std::string, json>& p_observables);
+
+		/**
+		 * Numbers are compared as double: 1 and 1.0 must be the same index key
+		 * @param p_value The value
+		 * @return The value used as index key
+		 **/
+		static json normalize(const json& p_value);
+
+		/**
+		 * Serialize query
+		 * @param p_archive archive
+		 */
+		template<class Archive>
+		void save(Archive& p_archive) const {
+			p_archive(m_predicates.size());
+			for (const Predicate& l_predicate: m_predicates) {
+				p_archive(l_predicate.m_key, l_predicate.m_is_range, json::to_msgpack(l_predicate.m_value),
+						  l_predicate.m_min, l_predicate.m_max);
+			}
+		}
+
+		/**
+		 * Deserialize query
+		 * @param p_archive archive
+		 */
+		template<class Archive>
+		void load(Archive& p_archive) {
+			size_t l_size;
+			p_archive(l_size);
+			m_predicates.resize(l_size);
+			for (Predicate& l_predicate: m_predicates) {
+				std::vector<std::uint8_t> l_value;
+				p_archive(l_predicate.m_key, l_predicate.m_is_range, l_value, l_predicate.m_min, l_predicate.m_max);
+				l_predicate.m_value = json::from_msgpack(l_value);
+			}
+		}
+	};
+
+} // namespace cam
@@ -0,0 +1,113 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Counter-based random stream (SplitMix64): the n-th value is a pure function of the seed,
+	 * the stream number and n, so independent and reproducible streams are created for free,
+	 * one per environment and one per agent, without shared state between threads.
+	 * Satisfies UniformRandomBitGenerator, but uniform_int and uniform_real should be preferred
+	 * to the standard distributions, whose results depend on the standard library.
+	 */
+	class RandomStream {
+		/**
+		 * Key of the stream
+		 */
+		std::uint64_t m_key;
+
+		/**
+		 * Number of values drawn
+		 */
+		std::uint64_t m_counter;
+
+	public:
+		using result_type = std::uint64_t;
+
+		/**
+		 * Create a stream
+		 * @param p_seed seed of the environment
+		 * @param p_stream stream number
+		 */
+		explicit RandomStream(const std::uint64_t p_seed = 0, const std::uint64_t p_stream = 0) :
+				m_key(mix(mix(p_seed) ^ (p_stream * 0xD1B54A32D192ED03ULL))),
+				m_counter(0) {}
+
+		static constexpr result_type min() { return 0; }
+
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+		/**
+		 * Next value
+		 * @return random value on 64 bits
+		 */
+		result_type operator()() {
+			return mix(m_key + ++m_counter * 0x9E3779B97F4A7C15ULL);
+		}
+
+		/**
+		 * Uniform integer, without modulo bias
+		 * @param p_min min value
+		 * @param p_max max value (included)
+		 * @return random value between min and max
+		 */
+		std::uint64_t uniform_int(const std::uint64_t p_min, const std::uint64_t p_max) {
+			const std::uint64_t l_range = p_max - p_min + 1;
+			if (l_range == 0) {
+				return (*this)();
+			}
+			// Reject the first 2^64 % range values, the others are a multiple of range
+			const std::uint64_t l_threshold = (max() - l_range + 1) % l_range;
+			std::uint64_t l_value;
+			do {
+				l_value = (*this)();
+			} while (l_value < l_threshold);
+			return p_min + l_value % l_range;
+		}
+
+		/**
+		 * Uniform real in [0, 1)
+		 * @return random value
+		 */
+		double uniform_real() {
+			return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+		}
+
+	private:
+
+		/**
+		 * SplitMix64 finalizer
+		 * @param p_value value
+		 * @return mixed value
+		 */
+		static constexpr std::uint64_t mix(std::uint64_t p_value) {
+			p_value = (p_value ^ (p_value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			p_value = (p_value ^ (p_value >> 27)) * 0x94D049BB133111EBULL;
+			return p_value ^ (p_value >> 31);
+		}
+	};
+
+} // namespace cam
@@ -0,0 +1,75 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include "SpatialGrid.h"
+
+void cam::SpatialGrid::build() {
+	m_points.clear();
+	m_cell_starts.clear();
+	if (m_inserted_points.empty() || !is_enabled()) {
+		m_inserted_points.clear();
+		return;
+	}
+
+	// Bounds
+	m_min_x = m_inserted_points.front().m_x;
+	m_min_y = m_inserted_points.front().m_y;
+	double l_max_x = m_min_x;
+	double l_max_y = m_min_y;
+	for (const Point& l_point: m_inserted_points) {
+		m_min_x = std::min(m_min_x, l_point.m_x);
+		m_min_y = std::min(m_min_y, l_point.m_y);
+		l_max_x = std::max(l_max_x, l_point.m_x);
+		l_max_y = std::max(l_max_y, l_point.m_y);
+	}
+
+	// Sparse points would give more cells than points: grow the cells instead
+	const double l_max_cells = std::max<double>(1024, 2 * static_cast<double>(m_inserted_points.size()));
+	m_build_cell_size = m_cell_size;
+	double l_columns;
+	double l_rows;
+	while (true) {
+		l_columns = std::floor((l_max_x - m_min_x) / m_build_cell_size) + 1;
+		l_rows = std::floor((l_max_y - m_min_y) / m_build_cell_size) + 1;
+		if (l_columns * l_rows <= l_max_cells) {
+			break;
+		}
+		m_build_cell_size *= 2;
+	}
+	m_columns = static_cast<size_t>(l_columns);
+	m_rows = static_cast<size_t>(l_rows);
+
+	// Counting sort by cell
+	m_cell_starts.assign(m_columns * m_rows + 1, 0);
+	for (const Point& l_point: m_inserted_points) {
+		const size_t l_cell = get_cell(l_point.m_y, m_min_y, m_rows) * m_columns +
+							  get_cell(l_point.m_x, m_min_x, m_columns);
+		m_cell_starts[l_cell + 1]++;
+	}
+	for (size_t l_cell = 1; l_cell < m_cell_starts.size(); l_cell++) {
+		m_cell_starts[l_cell] += m_cell_starts[l_cell - 1];
+	}
+	m_points.resize(m_inserted_points.size());
+	std::vector<std::uint32_t> l_positions(m_cell_starts.begin(), m_cell_starts.end() - 1);
+	for (const Point& l_point: m_inserted_points) {
+		const size_t l_cell = get_cell(l_point.m_y, m_min_y, m_rows) * m_columns +
+							  get_cell(l_point.m_x, m_min_x, m_columns);
+		m_points[l_positions[l_cell]++] = l_point;
+	}
+	m_inserted_points.clear();
+}
@@ -0,0 +1,168 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Uniform grid of 2D points, rebuilt from scratch (counting sort by cell) once per turn.
+	 * Points of a cell are contiguous, a radius query only visits the cells overlapping the
+	 * bounding square of the circle.
+	 **/
+	class SpatialGrid final {
+		/**
+		 * Point and its index given by the caller
+		 **/
+		struct Point {
+			double m_x;
+			double m_y;
+			std::uint32_t m_index;
+		};
+
+	protected:
+		/**
+		 * Requested cell size, 0 if disabled
+		 **/
+		double m_cell_size;
+
+		/**
+		 * Cell size used by the current build (may be larger to bound the number of cells)
+		 **/
+		double m_build_cell_size;
+
+		/**
+		 * Origin and size of the grid
+		 **/
+		double m_min_x;
+		double m_min_y;
+		size_t m_columns;
+		size_t m_rows;
+
+		/**
+		 * First point of each cell in m_points (plus the end)
+		 **/
+		std::vector<std::uint32_t> m_cell_starts;
+
+		/**
+		 * Points sorted by cell
+		 **/
+		std::vector<Point> m_points;
+
+		/**
+		 * Points inserted since the last build
+		 **/
+		std::vector<Point> m_inserted_points;
+
+	public:
+		/**
+		 * Disabled grid
+		 **/
+		SpatialGrid() :
+				m_cell_size(0),
+				m_build_cell_size(0),
+				m_min_x(0),
+				m_min_y(0),
+				m_columns(0),
+				m_rows(0) {}
+
+		/**
+		 * Set cell size
+		 * @param p_cell_size The cell size, about the perception radius, 0 to disable
+		 **/
+		void set_cell_size(const double p_cell_size) { m_cell_size = std::max(0.0, p_cell_size); }
+
+		/**
+		 * True if enabled
+		 * @return True if the cell size is not 0
+		 **/
+		[[nodiscard]] bool is_enabled() const { return m_cell_size > 0; }
+
+		/**
+		 * Insert a point for the next build
+		 * @param p_x X
+		 * @param p_y Y
+		 * @param p_index Index returned by queries
+		 **/
+		void insert(const double p_x, const double p_y, const std::uint32_t p_index) {
+			m_inserted_points.push_back({p_x, p_y, p_index});
+		}
+
+		/**
+		 * Index the inserted points, the previous ones are dropped
+		 **/
+		void build();
+
+		/**
+		 * Call p_function(index) for each point at distance p_radius or less from (p_x, p_y)
+		 * @param p_x X
+		 * @param p_y Y
+		 * @param p_radius Radius
+		 * @param p_function Function called with the index of each point
+		 **/
+		template<typename F>
+		void for_each_in_radius(const double p_x, const double p_y, const double p_radius, F&& p_function) const {
+			if (m_points.empty()) {
+				return;
+			}
+			const size_t l_first_column = get_cell(p_x - p_radius, m_min_x, m_columns);
+			const size_t l_last_column = get_cell(p_x + p_radius, m_min_x, m_columns);
+			const size_t l_first_row = get_cell(p_y - p_radius, m_min_y, m_rows);
+			const size_t l_last_row = get_cell(p_y + p_radius, m_min_y, m_rows);
+			const double l_squared_radius = p_radius * p_radius;
+			for (size_t l_row = l_first_row; l_row <= l_last_row; l_row++) {
+				const size_t l_row_start = l_row * m_columns;
+				for (std::uint32_t l_point_index = m_cell_starts[l_row_start + l_first_column];
+					 l_point_index < m_cell_starts[l_row_start + l_last_column + 1]; l_point_index++) {
+					const Point& l_point = m_points[l_point_index];
+					const double l_dx = l_point.m_x - p_x;
+					const double l_dy = l_point.m_y - p_y;
+					if (l_dx * l_dx + l_dy * l_dy <= l_squared_radius) {
+						p_function(l_point.m_index);
+					}
+				}
+			}
+		}
+
+	private:
+
+		/**
+		 * Cell of a coordinate, clamped to the grid
+		 * @param p_value The coordinate
+		 * @param p_min Grid origin
+		 * @param p_count Number of cells
+		 * @return The cell
+		 **/
+		[[nodiscard]] size_t get_cell(const double p_value, const double p_min, const size_t p_count) const {
+			const double l_cell = std::floor((p_value - p_min) / m_build_cell_size);
+			if (!(l_cell > 0)) {
+				return 0;
+			}
+			return std::min(static_cast<size_t>(std::min(l_cell, 1e18)), p_count - 1);
+		}
+	};
+
+} // namespace cam
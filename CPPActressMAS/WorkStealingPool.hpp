@@ -0,0 +1,334 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * CPPActressMAS
+ */
+namespace cam {
+
+	/**
+	 * Work-stealing pool executing contiguous index ranges.
+	 * Each worker owns a deque of ranges: it takes its own work from the front and, once empty,
+	 * steals from the back of the other workers. One job is published per parallel_for and the
+	 * caller waits on a single completion counter, so no allocation is done per range.
+	 */
+	class WorkStealingPool {
+		/**
+		 * Range of indexes [m_begin, m_end), a pinned range is never stolen
+		 */
+		struct Range {
+			size_t m_begin;
+			size_t m_end;
+			bool m_pinned;
+		};
+
+		/**
+		 * Worker deque, padded to avoid false sharing between workers
+		 */
+		struct alignas(64) Worker {
+			std::mutex m_mutex;
+			std::vector<Range> m_ranges;
+			size_t m_head = 0;
+		};
+
+		/**
+		 * Workers deques
+		 */
+		std::vector<std::unique_ptr<Worker>> m_workers;
+
+		/**
+		 * Worker threads
+		 */
+		std::vector<std::thread> m_threads;
+
+		/**
+		 * Current job
+		 */
+		void* m_job_context;
+		void (* m_job)(void*, size_t, size_t);
+
+		/**
+		 * Number of ranges not executed yet (turn-completion latch)
+		 */
+		std::atomic<size_t> m_pending;
+
+		/**
+		 * Incremented each time work is published, workers sleep on it
+		 */
+		std::atomic<std::uint64_t> m_generation;
+
+		/**
+		 * False when the pool is stopping
+		 */
+		std::atomic<bool> m_running;
+
+		/**
+		 * First exception thrown by the current job
+		 */
+		std::exception_ptr m_exception;
+		std::mutex m_exception_mutex;
+
+	public:
+
+		/**
+		 * Start the workers
+		 * @param p_number_of_threads number of workers (at least one)
+		 */
+		explicit WorkStealingPool(const size_t p_number_of_threads) :
+				m_job_context(nullptr),
+				m_job(nullptr),
+				m_pending(0),
+				m_generation(0),
+				m_running(true) {
+			const size_t l_number_of_threads = std::max<size_t>(1, p_number_of_threads);
+			for (size_t l_index = 0; l_index < l_number_of_threads; l_index++) {
+				m_workers.push_back(std::make_unique<Worker>());
+			}
+			for (size_t l_index = 0; l_index < l_number_of_threads; l_index++) {
+				m_threads.emplace_back([this, l_index] { worker_loop(l_index); });
+			}
+		}
+
+		/**
+		 * Stop and join all workers
+		 */
+		~WorkStealingPool() {
+			m_running.store(false, std::memory_order_release);
+			m_generation.fetch_add(1, std::memory_order_release);
+			m_generation.notify_all();
+			for (std::thread& l_thread: m_threads) {
+				l_thread.join();
+			}
+		}
+
+		/**
+		 * Number of workers
+		 * @return number of workers
+		 */
+		[[nodiscard]] size_t get_number_of_threads() const { return m_workers.size(); }
+
+		/**
+		 * Split [p_begin, p_end) into ranges of p_grain indexes and run p_function(begin, end) on each
+		 * of them. Blocks until every range is done, the calling thread helps meanwhile.
+		 * Must not be called concurrently or from inside a job.
+		 * @param p_begin first index
+		 * @param p_end last index (excluded)
+		 * @param p_grain number of indexes per range
+		 * @param p_function function called with (begin, end)
+		 */
+		template<typename F>
+		void parallel_for(const size_t p_begin, const size_t p_end, const size_t p_grain, F&& p_function) {
+			if (p_begin >= p_end) {
+				return;
+			}
+			using Function = std::remove_reference_t<F>;
+			const size_t l_grain = std::max<size_t>(1, p_grain);
+			const size_t l_count = (p_end - p_begin + l_grain - 1) / l_grain;
+			const size_t l_number_of_workers = m_workers.size();
+
+			// Not worth waking up the workers
+			if (l_count == 1) {
+				p_function(p_begin, p_end);
+				return;
+			}
+
+			m_job_context = const_cast<void*>(static_cast<const void*>(std::addressof(p_function)));
+			m_job = [](void* p_context, const size_t p_range_begin, const size_t p_range_end) {
+				(*static_cast<Function*>(p_context))(p_range_begin, p_range_end);
+			};
+			m_exception = nullptr;
+			m_pending.store(l_count, std::memory_order_relaxed);
+
+			// Each worker receives a contiguous block of ranges
+			for (size_t l_worker_index = 0; l_worker_index < l_number_of_workers; l_worker_index++) {
+				const size_t l_first = l_count * l_worker_index / l_number_of_workers;
+				const size_t l_last = l_count * (l_worker_index + 1) / l_number_of_workers;
+				if (l_first == l_last) {
+					continue;
+				}
+				Worker& l_worker = *m_workers[l_worker_index];
+				std::lock_guard l_lock(l_worker.m_mutex);
+				for (size_t l_range = l_first; l_range < l_last; l_range++) {
+					const size_t l_range_begin = p_begin + l_range * l_grain;
+					l_worker.m_ranges.push_back({l_range_begin, std::min(l_range_begin + l_grain, p_end), false});
+				}
+			}
+			m_generation.fetch_add(1, std::memory_order_release);
+			m_generation.notify_all();
+
+			// Help, then wait for the last range
+			Range l_range{};
+			while (steal(l_number_of_workers, l_range)) {
+				execute(l_range);
+			}
+			wait();
+		}
+
+		/**
+		 * Run p_function(index) for each index of [0, p_count). Index i always runs on worker
+		 * i % number of workers and is never stolen, so that the data owned by an index stays
+		 * in the cache of the same worker from one call to the next.
+		 * Blocks until every index is done. Must not be called concurrently or from inside a job.
+		 * @param p_count number of indexes
+		 * @param p_function function called with the index
+		 */
+		template<typename F>
+		void parallel_for_pinned(const size_t p_count, F&& p_function) {
+			if (p_count == 0) {
+				return;
+			}
+			using Function = std::remove_reference_t<F>;
+			const size_t l_number_of_workers = m_workers.size();
+
+			m_job_context = const_cast<void*>(static_cast<const void*>(std::addressof(p_function)));
+			m_job = [](void* p_context, const size_t p_index, const size_t) {
+				(*static_cast<Function*>(p_context))(p_index);
+			};
+			m_exception = nullptr;
+			m_pending.store(p_count, std::memory_order_relaxed);
+			for (size_t l_index = 0; l_index < p_count; l_index++) {
+				Worker& l_worker = *m_workers[l_index % l_number_of_workers];
+				std::lock_guard l_lock(l_worker.m_mutex);
+				l_worker.m_ranges.push_back({l_index, l_index + 1, true});
+			}
+			m_generation.fetch_add(1, std::memory_order_release);
+			m_generation.notify_all();
+			wait();
+		}
+
+		// Delete copy constructor
+		WorkStealingPool(const WorkStealingPool&) = delete;
+
+		WorkStealingPool& operator=(WorkStealingPool&) = delete;
+
+	private:
+
+		/**
+		 * Wait for the last range of the current job, rethrow its first exception
+		 */
+		void wait() {
+			size_t l_pending;
+			while ((l_pending = m_pending.load(std::memory_order_acquire)) != 0) {
+				m_pending.wait(l_pending, std::memory_order_acquire);
+			}
+			if (m_exception) {
+				std::rethrow_exception(m_exception);
+			}
+		}
+
+		/**
+		 * Worker main loop
+		 * @param p_index worker index
+		 */
+		void worker_loop(const size_t p_index) {
+			std::uint64_t l_generation = m_generation.load(std::memory_order_acquire);
+			Range l_range{};
+			while (true) {
+				if (pop(p_index, l_range) || steal(p_index, l_range)) {
+					execute(l_range);
+					continue;
+				}
+				if (!m_running.load(std::memory_order_acquire)) {
+					return;
+				}
+				m_generation.wait(l_generation, std::memory_order_acquire);
+				l_generation = m_generation.load(std::memory_order_acquire);
+			}
+		}
+
+		/**
+		 * Take a range from the front of the worker deque
+		 * @param p_index worker index
+		 * @param p_range output range
+		 * @return false if empty
+		 */
+		bool pop(const size_t p_index, Range& p_range) {
+			Worker& l_worker = *m_workers[p_index];
+			std::lock_guard l_lock(l_worker.m_mutex);
+			if (l_worker.m_head == l_worker.m_ranges.size()) {
+				return false;
+			}
+			p_range = l_worker.m_ranges[l_worker.m_head++];
+			if (l_worker.m_head == l_worker.m_ranges.size()) {
+				l_worker.m_ranges.clear();
+				l_worker.m_head = 0;
+			}
+			return true;
+		}
+
+		/**
+		 * Steal a range from the back of another worker deque, except pinned ranges
+		 * @param p_index thief index (may be out of range for a non-worker thread)
+		 * @param p_range output range
+		 * @return false if every other deque is empty
+		 */
+		bool steal(const size_t p_index, Range& p_range) {
+			const size_t l_number_of_workers = m_workers.size();
+			for (size_t l_offset = 1; l_offset <= l_number_of_workers; l_offset++) {
+				const size_t l_victim_index = (p_index + l_offset) % l_number_of_workers;
+				if (l_victim_index == p_index) {
+					continue;
+				}
+				Worker& l_victim = *m_workers[l_victim_index];
+				std::lock_guard l_lock(l_victim.m_mutex);
+				if (l_victim.m_head == l_victim.m_ranges.size() || l_victim.m_ranges.back().m_pinned) {
+					continue;
+				}
+				p_range = l_victim.m_ranges.back();
+				l_victim.m_ranges.pop_back();
+				if (l_victim.m_head == l_victim.m_ranges.size()) {
+					l_victim.m_ranges.clear();
+					l_victim.m_head = 0;
+				}
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		 * Run a range of the current job and count it down
+		 * @param p_range the range
+		 */
+		void execute(const Range& p_range) {
+			try {
+				m_job(m_job_context, p_range.m_begin, p_range.m_end);
+			} catch (...) {
+				std::lock_guard l_lock(m_exception_mutex);
+				if (!m_exception) {
+					m_exception = std::current_exception();
+				}
+			}
+			if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				m_pending.notify_all();
+			}
+		}
+	};
+
+} // namespace cam
@@ -0,0 +1,118 @@
+/**************************************************************************
+ *                                                                        *
+ *  Description: CPPActressMas multi-agent framework                      *
+ *  Website:     https://github.com/jferdelyi/CPPActressMAS               *
+ *  Copyright:   (c) 2023-Today, Jean-François Erdelyi                    *
+ *                                                                        *
+ *  CPP version of ActressMAS by Florin Leon                              *
+ *  https://github.com/florinleon/ActressMas                              *
+ *                                                                        *
+ *  This program is free software; you can redistribute it and/or modify  *
+ *  it under the terms of the GNU General License as published by         *
+ *  the Free Software Foundation. This program is distributed in the      *
+ *  hope that it will be useful, but WITHOUT ANY WARRANTY; without even   *
+ *  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR   *
+ *  PURPOSE. See the GNU General License for more details.                *
+ *                                                                        *
+ **************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include <Environment.h>
+#include <Agent.h>
+
+static constexpr int POINT_COUNT = 50000;
+static constexpr int OBSERVER_COUNT = 50;
+static constexpr int TURN_COUNT = 10;
+static constexpr double MIN_VALUE = 0.25;
+static constexpr double MAX_VALUE = 0.5;
+
+static cam::ObservableKey s_value_key;
+static std::atomic<size_t> s_perceived;
+
+/**
+ * How observers perceive the points
+ */
+enum class PerceptionMode {
+	Filter,        // perception_filter on json observables
+	Query,         // PerceptionQuery on json observables
+	Columns        // ColumnQuery on typed observables
+};
+
+class PointAgent : public cam::Agent {
+	protected:
+		double m_value;
+
+	public:
+		explicit PointAgent(const double p_value) :
+			Agent("point"),
+			m_value(p_value) {}
+
+		void setup() override {
+			edit_observables()["value"] = m_value;
+			set_observable(s_value_key, m_value);
+		}
+};
+
+class ObserverAgent : public cam::Agent {
+	protected:
+		PerceptionMode m_mode;
+
+	public:
+		explicit ObserverAgent(const PerceptionMode p_mode) :
+			Agent("observer", p_mode != PerceptionMode::Columns),
+			m_mode(p_mode) {
+			if (m_mode == PerceptionMode::Query) {
+				m_perception_query.where_in_range("value", MIN_VALUE, MAX_VALUE);
+			}
+		}
+
+		[[nodiscard]] bool perception_filter(const cam::ObservablesPointer& p_observed) const override {
+			const auto& l_it = p_observed->find("value");
+			if (l_it == p_observed->end()) {
+				return false;
+			}
+			const auto l_value = l_it->second.get<double>();
+			return l_value >= MIN_VALUE && l_value <= MAX_VALUE;
+		}
+
+		void see(const std::vector<cam::ObservablesPointer>& p_observable_agents) override {
+			s_perceived += p_observable_agents.size();
+		}
+
+		void default_action() override {
+			if (m_mode == PerceptionMode::Columns) {
+				s_perceived += select_agents(cam::ColumnQuery().where_in_range(s_value_key, MIN_VALUE, MAX_VALUE)).size();
+			}
+		}
+};
+
+void run(const std::string& p_name, const PerceptionMode p_mode) {
+	cam::Environment l_environment(TURN_COUNT, cam::EnvironmentMasMode::Parallel, 0, 42);
+	s_value_key = l_environment.register_observable("value");
+	s_perceived = 0;
+
+	std::mt19937 l_generator(42);
+	std::uniform_real_distribution<double> l_distribution(0, 1);
+	for (int i = 0; i < POINT_COUNT; i++) {
+		l_environment.add<PointAgent>(l_distribution(l_generator));
+	}
+	for (int i = 0; i < OBSERVER_COUNT; i++) {
+		l_environment.add<ObserverAgent>(p_mode);
+	}
+
+	const auto& l_start_time = std::chrono::high_resolution_clock::now();
+	l_environment.start();
+	const auto& l_end_time = std::chrono::high_resolution_clock::now();
+	const auto& l_elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(l_end_time - l_start_time).count();
+	std::cout << p_name << ": " << l_elapsed_time << "ms, " << s_perceived << " perceived" << std::endl;
+}
+
+int main() {
+	run("perception_filter", PerceptionMode::Filter);
+	run("PerceptionQuery", PerceptionMode::Query);
+	run("ColumnQuery", PerceptionMode::Columns);
+}
@@ -17,6 +17,7 @@
  **************************************************************************/
 
 #include <iostream>
+#include <string_view>
 
 #include <Environment.h>
 #include <Agent.h>
@@ -26,15 +27,15 @@ static constexpr int AGENT_COUNT = 10000;
 
 class MyAgent : public cam::Agent {
 	protected:
-		std::string m_parent_id;
+		cam::AgentId m_parent_id;
 		int m_sum;
 		int m_sum_id;
 		int m_message_left;
 
 	public:
-		explicit MyAgent(const std::string& p_name, const int p_sum_id, std::string p_parent_id) :
+		explicit MyAgent(const std::string& p_name, const int p_sum_id, const cam::AgentId& p_parent_id) :
 			Agent(p_name),
-			m_parent_id(std::move(p_parent_id)),
+			m_parent_id(p_parent_id),
 			m_sum(p_sum_id),
 			m_sum_id(p_sum_id),
 			m_message_left(0) {}
@@ -48,31 +49,41 @@ class MyAgent : public cam::Agent {
 			}
 
 			if (m_message_left == 0) {
-				send(m_parent_id, {{"sum", m_sum_id}}); // send id to parent
+				send_object(m_parent_id, m_sum_id); // send id to parent
 				stop();
 			}
 		}
 
-		void action(const cam::MessagePointer& p_message) override {
-			m_sum += static_cast<int>(p_message->content()["sum"]);
-			m_message_left--;
+		void action_batch(const std::span<const cam::MessagePointer> p_messages) override {
+			for (const auto& l_message : p_messages) {
+				m_sum += l_message->as<int>();
+			}
+			m_message_left -= static_cast<int>(p_messages.size());
 
 			if (m_message_left == 0) {
 				if (get_name() == "a0") {
 					std::cout << "Sum " << m_sum << std::endl;
 				} else {
-					send(m_parent_id, {{"sum", m_sum}}); // send id to parent
+					send_object(m_parent_id, m_sum); // send id to parent
 				}
 				stop();
 			}
 		}
 };
 
-int main() {
+int main(const int p_argc, char** p_argv) {
+	// Parallel by default, "reactive" or "asynchronous" to compare the schedulers
+	cam::EnvironmentMasMode l_mode = cam::EnvironmentMasMode::Parallel;
+	if (p_argc > 1 && std::string_view(p_argv[1]) == "reactive") {
+		l_mode = cam::EnvironmentMasMode::Reactive;
+	} else if (p_argc > 1 && std::string_view(p_argv[1]) == "asynchronous") {
+		l_mode = cam::EnvironmentMasMode::Asynchronous;
+	}
+
 	const auto& l_start_time = std::chrono::high_resolution_clock::now();
 
-	cam::Environment l_environment(0, cam::EnvironmentMasMode::Parallel);
-	l_environment.add<MyAgent>("a0", 0, "");
+	cam::Environment l_environment(0, l_mode);
+	l_environment.add<MyAgent>("a0", 0, cam::AgentId());
 	l_environment.start();
 
 	const auto& l_end_time = std::chrono::high_resolution_clock::now();
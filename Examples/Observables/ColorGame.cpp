@@ -61,8 +61,8 @@ class MyAgent : public cam::Agent {
                     std::cout << l_observable->at("Name") << " (" << l_observable->at("Color") << ")" << std::endl;
 		        }
 		    }
-			m_observables->erase("Color");
-			m_observables->emplace(std::make_pair("Color", Colors::GenerateColor()));
+			edit_observables().erase("Color");
+			edit_observables().emplace(std::make_pair("Color", Colors::GenerateColor()));
 		    std::cout << "My color is now " << m_observables->at("Color") << std::endl;
 		    std::cout << "----------------------------------------------" << std::endl;
 		}
@@ -74,13 +74,10 @@ public:
 
 protected:
 	void setup() override {
-		m_observables->emplace(std::make_pair("Name", get_name()));
-		m_observables->emplace(std::make_pair("Color", "red"));
+		edit_observables().emplace(std::make_pair("Name", get_name()));
+		edit_observables().emplace(std::make_pair("Color", "red"));
 		m_see_color = "green";
-	}
-
-	bool perception_filter(const cam::ObservablesPointer& p_observed) const override {
-		return p_observed->at("Color") == m_see_color;
+		m_perception_query.where_equal("Color", m_see_color);
 	}
 };
 
@@ -90,13 +87,10 @@ public:
 
 protected:
 	void setup() override {
-		m_observables->emplace(std::make_pair("Name", get_name()));
-		m_observables->emplace(std::make_pair("Color", "green"));
+		edit_observables().emplace(std::make_pair("Name", get_name()));
+		edit_observables().emplace(std::make_pair("Color", "green"));
 		m_see_color = "blue";
-	}
-
-	bool perception_filter(const cam::ObservablesPointer& p_observed) const override {
-		return p_observed->at("Color") == m_see_color;
+		m_perception_query.where_equal("Color", m_see_color);
 	}
 };
 
@@ -107,13 +101,10 @@ public:
 
 protected:
 	void setup() override {
-		m_observables->emplace(std::make_pair("Name", get_name()));
-		m_observables->emplace(std::make_pair("Color", "blue"));
+		edit_observables().emplace(std::make_pair("Name", get_name()));
+		edit_observables().emplace(std::make_pair("Color", "blue"));
 		m_see_color = "red";
-	}
-
-	bool perception_filter(const cam::ObservablesPointer& p_observed) const override {
-		return p_observed->at("Color") == m_see_color;
+		m_perception_query.where_equal("Color", m_see_color);
 	}
 };
 
@@ -42,8 +42,8 @@ class MyAgent : public cam::Agent {
 		}
 
 		void setup() override {
-		    m_observables->emplace(std::make_pair("Name", get_name()));
-			m_observables->emplace(std::make_pair("Number", Numbers::GenerateNumber()));
+		    edit_observables().emplace(std::make_pair("Name", get_name()));
+			edit_observables().emplace(std::make_pair("Number", Numbers::GenerateNumber()));
 		}
 
 		bool perception_filter(const cam::ObservablesPointer& p_observed) const override {
@@ -69,8 +69,8 @@ class MyAgent : public cam::Agent {
                     std::cout << l_observable->at("Name") << " with number = " << l_observable->at("Number") << std::endl;
 		        }
 		    }
-			m_observables->erase("Number");
-			m_observables->insert(std::make_pair("Number", Numbers::GenerateNumber()));
+			edit_observables().erase("Number");
+			edit_observables().insert(std::make_pair("Number", Numbers::GenerateNumber()));
 		    std::cout << "My number is now " << m_observables->at("Number") << std::endl;
 		    std::cout << "----------------------------------------------" << std::endl;
 		}
@@ -30,8 +30,8 @@ public:
 
 	void setup() override {
 		// Set observables
-		m_observables->emplace(std::make_pair("number", 42));
-		m_observables->emplace(std::make_pair("color", "blue"));
+		edit_observables().emplace(std::make_pair("number", 42));
+		edit_observables().emplace(std::make_pair("color", "blue"));
 
 		std::cout << "Setup" << std::endl;
 		std::cout << get_name() << std::endl;